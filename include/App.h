@@ -2,8 +2,8 @@
 #define __APP_H__
 
 #include <SDL.h>
-#include "../include/ROM.h"
-#include "../include/PPU.h"
+#include "../include/NES.h"
+#include "../include/REWIND.h"
 
 
 class App{
@@ -20,8 +20,14 @@ class App{
         static const int WindowWidth = 256*4;
         static const int WindowHeight = 240*4;
 
-        rom::ROM *rom = NULL;
-        ppu::PPU *ppu = NULL;
+        // THE MACHINE; App ONLY ADDS THE WINDOW, KEYS AND REWIND ON TOP.
+        nes::NES *nes = NULL;
+
+        // EVERY FRAME GOES INTO THE REWIND BUFFER; HOLDING BACKSPACE STEPS BACK
+        // ONE FRAME PER LOOP INSTEAD OF RUNNING ONE.
+        static const size_t RewindBytes = 8 * 1024 * 1024;
+        history::Buffer *rewind = NULL;
+        bool Rewinding = false;
         
     private:
         
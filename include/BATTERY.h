@@ -0,0 +1,97 @@
+#ifndef __BATTERY_H__
+#define __BATTERY_H__
+
+#include "MOS6502.h"
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stddef.h>
+
+namespace battery{
+
+    /**
+     * BATTERY BACKED PRG RAM ($6000-$7FFF) KEPT IN A .sav FILE.
+     *
+     * THE GAME KEEPS WRITING THE STATE ARENA'S SRAM (SO SNAPSHOTS, REWIND AND
+     * MOVIES STILL CARRY IT); THE FILE IS MAPPED SHARED AND FOLLOWS BEHIND:
+     *
+     *   EMULATION THREAD   update() ONCE A FRAME COMPARES SRAM WITH A SHADOW
+     *                      COPY AND, IF THE GAME WROTE ANYTHING, COPIES IT IN.
+     *                      IT ONLY try_lock()S, SO IF THE FLUSHER HOLDS THE
+     *                      SHADOW THE COPY WAITS FOR THE NEXT FRAME.
+     *   FLUSHER THREAD     EVERY interval MS, IF THE SHADOW CHANGED, COPIES IT
+     *                      INTO THE MAPPING AND msync()S IT.
+     *
+     * THE EMULATION THREAD NEVER TOUCHES THE MAPPING, SO NEITHER A PAGE FAULT
+     * ON IT NOR A PAGE UNDER WRITEBACK CAN STALL A FRAME. ONCE A WRITE IS IN
+     * THE MAPPING THE KERNEL HAS IT, SO A CRASH OF THE PROCESS LOSES AT MOST
+     * THE LAST interval; close() (AND THE DESTRUCTOR) FLUSH EVERYTHING.
+     *
+     * WITHOUT mmap (WIN32) THE FLUSHER REWRITES THE FILE INSTEAD.
+     */
+
+    static const uint32_t INTERVAL = 250;      // MS
+
+    struct Stats{
+        uint64_t updates;       // FRAMES THAT FOUND SRAM CHANGED
+        uint64_t deferred;      // ... AND LEFT IT TO THE NEXT FRAME, FLUSHER BUSY
+        uint64_t syncs;         // FLUSHES TO THE FILE
+    };
+
+    class Save{
+
+        private:
+
+            mos6502::i8 *sram;
+            size_t size;
+            mos6502::i8 *file;              // THE MAPPING, ONLY THE FLUSHER WRITES IT
+            int fd;
+#ifdef WIN32
+            std::string path;
+#endif
+            std::vector<mos6502::i8> shadow;
+            uint32_t interval;
+            Stats stats;
+
+            std::thread flusher;
+            std::mutex mutex;               // GUARDS shadow, pending, stopping
+            std::condition_variable wake;
+            bool pending;                   // shadow NEWER THAN THE MAPPING
+            bool stopping;
+
+            void run();
+            int persist();
+
+            Save(const Save &);
+            Save &operator=(const Save &);
+
+        public:
+
+            Save();
+
+            // MAP path (CREATED, OR GROWN, TO size BYTES OF ZEROS) BEHIND sram,
+            // COPY IT INTO sram AND START THE FLUSHER. 0, OR -1 IF THE FILE
+            // CANNOT BE OPENED OR MAPPED, WHICH LEAVES sram AS IT WAS.
+            int open(const char *path, mos6502::i8 *sram, size_t size, uint32_t interval = INTERVAL);
+            bool isOpen() const{return this->file != NULL;}
+
+            // ON THE EMULATION THREAD, ONCE A FRAME. NEVER WAITS UNLESS block.
+            void update(bool block = false);
+
+            // PUT THE SAVED CONTENTS BACK INTO sram, AFTER A RESET CLEARED IT.
+            // WHAT update() HAS SEEN COUNTS AS SAVED.
+            void load();
+
+            // update(), STOP THE FLUSHER, FLUSH AND UNMAP. BLOCKS ON THE DISK.
+            void close();
+
+            // FROM THE EMULATION THREAD.
+            Stats getStats();
+
+            ~Save();
+    };
+};
+
+#endif // !__BATTERY_H__
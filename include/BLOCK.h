@@ -0,0 +1,157 @@
+#ifndef __BLOCK_H__
+#define __BLOCK_H__
+
+#include "MOS6502.h"
+#include "BUS.h"
+#include <vector>
+#include <stddef.h>
+
+namespace cpu{
+    class CPU;
+};
+
+namespace block{
+
+    /**
+     * PRE-DECODED BASIC BLOCK CACHE.
+     *
+     * A BLOCK IS A RUN OF INSTRUCTIONS STARTING AT SOME PC, ENDING AFTER THE
+     * FIRST BRANCH/JUMP/RETURN OR AT THE END OF THE 256 BYTE PAGE, WITH OPCODE
+     * AND OPERAND BYTES ALREADY READ. BLOCKS ARE KEYED BY PC AND THE HOST PAGE
+     * THE BUS HAS MAPPED THERE, SO A BANK SWITCH SIMPLY STOPS MATCHING THE OLD
+     * BLOCKS (AND THEY HIT AGAIN WHEN THE BANK COMES BACK).
+     *
+     * CODE IN WRITABLE MEMORY (RAM, SRAM) IS WATCHED THROUGH THE BUS. THE FIRST
+     * WRITE TO SUCH A PAGE DROPS EVERY BLOCK BUILT FROM IT AND UNWATCHES IT, SO
+     * DATA WRITES ONLY PAY ONCE UNTIL CODE RUNS FROM THE PAGE AGAIN.
+     *
+     * CODE IN HANDLER PAGES (MMIO, OPEN BUS) IS NEVER CACHED: next() RETURNS
+     * NULL AND THE CPU DECODES FROM THE BUS AS BEFORE.
+     */
+
+    static const int BLOCK_SIZE = 16;       // INSTRUCTIONS PER BLOCK AT MOST
+    static const int CACHE_SIZE = 2048;     // DIRECT MAPPED ENTRIES, POWER OF TWO
+
+    // NATIVE CODE FOR A BLOCK PREFIX, SEE JIT.h.
+    typedef void (*NativeBlock)(cpu::CPU *cpu);
+
+    struct Instruction{
+        mos6502::i16 pc;
+        mos6502::i16 operand;
+        mos6502::i8  op;
+    };
+
+    struct Block{
+        const mos6502::i8 *host;            // HOST PAGE THE BLOCK WAS BUILT FROM
+        NativeBlock  native;                // NULL UNTIL THE JIT COMPILES IT
+        mos6502::i16 pc;
+        mos6502::i8  count;                 // 0 WHEN EMPTY OR INVALIDATED
+        mos6502::i8  nativeCount;           // INSTRUCTIONS COVERED BY native
+        mos6502::i8  writable;              // BUILT FROM RAM/SRAM, MAY BE REWRITTEN
+        mos6502::i8  idle;                  // POLLING LOOP CANDIDATE, SEE CPU::idle()
+        mos6502::i16 heat;                  // ENTRIES SEEN BY THE JIT TIER
+        mos6502::i16 nativeCycles;          // WORST CASE CYCLES OF THE NATIVE PREFIX
+        Instruction  ins[BLOCK_SIZE];
+    };
+
+    struct Stats{
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t invalidations;             // BLOCKS DROPPED BY CODE WRITES
+    };
+
+    class Cache{
+
+        private:
+
+            std::vector<Block> blocks;
+            bus::Bus *bus;
+            Stats stats;
+
+            // THE BLOCK BEING WALKED AND THE INDEX OF ITS NEXT INSTRUCTION.
+            Block *current;
+            int index;
+
+            // SET WHEN A BLOCK IS BUILT FROM RAM/SRAM, CLEARED BY THE FLUSHES.
+            bool writableCode;
+
+            void build(Block &block, mos6502::i16 pc, const mos6502::i8 *host);
+            bool isPollLoop(const Block &block);
+            static void codeWritten(void *context, const mos6502::i8 *page);
+            static void remapped(void *context);
+
+        public:
+
+            // AN ALWAYS EMPTY BLOCK, SO current IS NEVER NULL. ZEROED AS STATIC
+            // STORAGE AND NEVER WRITTEN, SO CACHES ON EVERY THREAD SHARE IT.
+            static Block empty;
+
+            Cache(bus::Bus &bus);
+
+            inline Block &lookup(mos6502::i16 pc){
+                const mos6502::i8 *host = this->bus->readPage(pc);
+                if(!host){
+                    return empty;
+                }
+                Block &block = this->blocks[(pc ^ ((uintptr_t)host >> 8)) & (CACHE_SIZE - 1)];
+                if(block.pc == pc && block.host == host && block.count){
+                    this->stats.hits++;
+                    return block;
+                }
+                this->stats.misses++;
+                this->build(block, pc, host);
+                return block;
+            }
+
+            // NEXT PRE-DECODED INSTRUCTION AT pc. WHEN pc IS NOT WHERE THE CURRENT
+            // BLOCK CONTINUES (BRANCH, JUMP, INTERRUPT, INVALIDATION, REMAP) THE
+            // BLOCK AT pc IS LOOKED UP. NULL WHEN pc CANNOT BE CACHED.
+            inline const Instruction *next(mos6502::i16 pc){
+                if(this->index >= this->current->count || this->current->ins[this->index].pc != pc){
+                    this->current = &this->lookup(pc);
+                    this->index = 0;
+                    if(!this->current->count){
+                        return NULL;
+                    }
+                }
+                return &this->current->ins[this->index++];
+            }
+
+            // THE BLOCK STARTING AT pc IF pc IS NOT INSIDE THE CURRENT WALK, ELSE
+            // NULL. USED BY THE JIT TIER, WHICH ONLY ENTERS AT BLOCK STARTS.
+            inline Block *enter(mos6502::i16 pc){
+                if(this->index < this->current->count && this->current->ins[this->index].pc == pc){
+                    return NULL;
+                }
+                this->current = &this->lookup(pc);
+                this->index = 0;
+                return this->current->count ? this->current : NULL;
+            }
+
+            // IS THE CURRENT BLOCK A POLLING LOOP CANDIDATE THAT BRANCHES BACK TO pc?
+            inline bool isIdleLoop(mos6502::i16 pc){
+                return this->current->idle && this->current->pc == pc;
+            }
+
+            // MARK THE FIRST count INSTRUCTIONS OF THE CURRENT BLOCK AS EXECUTED.
+            inline void skip(int count){
+                this->index = count;
+            }
+
+            // DROP EVERYTHING, E.G. AFTER PRG WAS REWRITTEN BEHIND THE BUS'S BACK.
+            void flush();
+
+            // DROP THE BLOCKS BUILT FROM RAM/SRAM, E.G. AFTER A SNAPSHOT WAS LOADED
+            // OVER THEM. FREE WHEN THERE ARE NONE.
+            void flushWritable();
+
+            // FORGET ALL NATIVE CODE, E.G. WHEN THE JIT ARENA IS RECYCLED.
+            void dropNative();
+
+            const Stats &getStats() const{return this->stats;}
+            void resetStats();
+    };
+
+};
+
+#endif // !__BLOCK_H__
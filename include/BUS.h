@@ -0,0 +1,149 @@
+#ifndef __BUS_H__
+#define __BUS_H__
+
+#include "MOS6502.h"
+#include "STATE.h"
+
+namespace bus{
+
+    // MMIO CALLBACKS. context IS WHATEVER WAS PASSED TO mapHandler().
+    typedef mos6502::i8 (*ReadHandler)(void *context, mos6502::i16 addr);
+    typedef void (*WriteHandler)(void *context, mos6502::i16 addr, mos6502::i8 data);
+
+    // CALLED BEFORE A WRITE LANDS IN A WATCHED CODE PAGE. page IS THE HOST
+    // MEMORY OF THE 256 BYTE PAGE, NOT THE CPU ADDRESS.
+    typedef void (*CodeWriteHandler)(void *context, const mos6502::i8 *page);
+
+    // CALLED AFTER ANY PAGE WAS REMAPPED (BANK SWITCH, NEW HANDLER).
+    typedef void (*RemapHandler)(void *context);
+
+    /**
+     * CPU ADDRESS BUS.
+     *
+     * THE 64 KB SPACE IS SPLIT INTO 256 PAGES OF 256 BYTES. A PAGE BACKED BY
+     * PLAIN MEMORY (RAM, SRAM, PRG) HAS A DIRECT POINTER IN readPages/writePages,
+     * SO THE COMMON ACCESS IS ONE TABLE LOAD PLUS ONE INDEXED LOAD. ONLY PAGES
+     * WITH A NULL POINTER FALL BACK TO THE PAGE'S HANDLER.
+     *
+     * DEFAULT MAP:
+     *   0X0000 - 0X1FFF  2 KB WORK RAM, MIRRORED 4 TIMES
+     *   0X2000 - 0X3FFF  PPU REGISTERS, MIRRORED EVERY 8 BYTES       (HANDLER)
+     *   0X4000 - 0X401F  APU / IO REGISTERS                          (HANDLER)
+     *   0X4020 - 0X5FFF  EXPANSION, OPEN BUS                         (HANDLER)
+     *   0X6000 - 0X7FFF  8 KB SRAM
+     *   0X8000 - 0XFFFF  32 KB PRG WINDOW, READ ONLY, WRITES GO TO THE HANDLER
+     */
+    class Bus{
+
+        private:
+
+            struct Region{
+                ReadHandler  read;
+                WriteHandler write;
+                void *readContext;
+                void *writeContext;
+            };
+
+            mos6502::i8 *readPages[256];
+            mos6502::i8 *writePages[256];
+            Region regions[256];
+
+            // WRITABLE PAGES HOLDING CACHED CODE. THEIR writePages ENTRY IS NULLED
+            // SO WRITES TAKE THE SLOW PATH AND REACH codeWriteHandler FIRST.
+            mos6502::i8 *watched[256];
+            CodeWriteHandler codeWriteHandler;
+            void *codeWriteContext;
+            RemapHandler remapHandler;
+            void *remapContext;
+
+            // RAM, SRAM AND THE REGISTER LATCHES BEHIND THE DEFAULT MMIO HANDLERS
+            // (UNTIL A DEVICE MAPS ITS OWN HANDLER OVER THEM) BELONG TO THE
+            // OWNER'S STATE ARENA, SEE STATE.h. PRG IS NOT STATE.
+            state::Memory *memory;
+            mos6502::i8 prg[0x8000];
+
+            static mos6502::i8 readPPULatch(void *context, mos6502::i16 addr);
+            static void writePPULatch(void *context, mos6502::i16 addr, mos6502::i8 data);
+            static mos6502::i8 readOpenBus(void *context, mos6502::i16 addr);
+            static void writeIgnored(void *context, mos6502::i16 addr, mos6502::i8 data);
+
+            bool isWatched(const mos6502::i8 *page);
+
+        public:
+
+            Bus(state::Memory &memory);
+
+            inline mos6502::i8 read(mos6502::i16 addr){
+                mos6502::i8 *page = this->readPages[addr >> 8];
+                if(page){
+                    return page[addr & 0xFF];
+                }
+                const Region &region = this->regions[addr >> 8];
+                return region.read(region.readContext, addr);
+            }
+
+            inline void write(mos6502::i16 addr, mos6502::i8 data){
+                mos6502::i8 *page = this->writePages[addr >> 8];
+                if(page){
+                    page[addr & 0xFF] = data;
+                    return;
+                }
+                page = this->watched[addr >> 8];
+                if(page){
+                    this->codeWriteHandler(this->codeWriteContext, page);
+                    page[addr & 0xFF] = data;
+                    return;
+                }
+                const Region &region = this->regions[addr >> 8];
+                region.write(region.writeContext, addr, data);
+            }
+
+            // HOST MEMORY BEHIND A CPU PAGE, NULL FOR HANDLER PAGES. A BANK SWITCH
+            // CHANGES THE POINTER, SO IT DOUBLES AS THE IDENTITY OF THE MAPPED BANK.
+            inline const mos6502::i8 *readPage(mos6502::i16 addr){
+                return this->readPages[addr >> 8];
+            }
+
+            // PLAIN MEMORY THAT ACCEPTS WRITES, WATCHED OR NOT.
+            inline bool isWritable(mos6502::i16 addr){
+                return this->writePages[addr >> 8] || this->watched[addr >> 8];
+            }
+
+            // ROUTE WRITES TO HOST PAGE page (THROUGH EVERY MIRROR) VIA THE CODE
+            // WRITE HANDLER UNTIL unwatchCode(). READ ONLY PAGES ARE IGNORED.
+            void watchCode(const mos6502::i8 *page);
+            void unwatchCode(const mos6502::i8 *page);
+            void setCodeWriteHandler(CodeWriteHandler handler, void *context);
+            void setRemapHandler(RemapHandler handler, void *context);
+
+            // MAP [start, end] (PAGE ALIGNED) ONTO memory, REPEATING EVERY size
+            // BYTES (A MULTIPLE OF 256). READ ONLY PAGES ROUTE WRITES TO THE
+            // HANDLER ALREADY MAPPED THERE.
+            void mapMemory(mos6502::i16 start, mos6502::i16 end, mos6502::i8 *memory, mos6502::i16 size, bool writable);
+
+            // ROUTE [start, end] (PAGE ALIGNED) TO CALLBACKS. read OR write MAY BE
+            // NULL TO KEEP THE CURRENT DIRECT MAPPING FOR THAT DIRECTION.
+            void mapHandler(mos6502::i16 start, mos6502::i16 end, ReadHandler read, WriteHandler write, void *context);
+
+            // THE DEFAULT $4000-$40FF HANDLERS, context IS THE BUS. A DEVICE THAT
+            // TAKES OVER SOME IO REGISTERS HANDS THE REST BACK TO THESE.
+            static mos6502::i8 readIOLatch(void *context, mos6502::i16 addr);
+            static void writeIOLatch(void *context, mos6502::i16 addr, mos6502::i8 data);
+
+            // MAP THE BUILT-IN 32 KB PRG WINDOW (getPRG()) AT $8000-$FFFF, WRITES
+            // IGNORED, AS AFTER CONSTRUCTION. A mapper::Mapper HANDS IT BACK SO.
+            void mapPRG();
+
+            // CLEAR RAM/SRAM/LATCHES TO THEIR POWER-ON CONTENTS.
+            void reset();
+
+            mos6502::i8 *getRAM(){return this->memory->ram;}
+            mos6502::i8 *getSRAM(){return this->memory->sram;}
+            mos6502::i8 *getPRG(){return this->prg;}
+
+            ~Bus();
+    };
+
+};
+
+#endif // !__BUS_H__
@@ -0,0 +1,116 @@
+#ifndef __CATALOG_H__
+#define __CATALOG_H__
+
+#include "MOS6502.h"
+#include <string>
+#include <iostream>
+#include <stddef.h>
+
+namespace catalog{
+
+    /**
+     * ROM LIBRARY INDEX.
+     *
+     * build() SCANS A DIRECTORY TREE FOR .nes, .nes.gz AND .zip FILES ON
+     * SEVERAL THREADS, LOADS EACH WITH rom::ROM (MAPPED, SO A PLAIN ONE IS NOT
+     * COPIED), HASHES ITS PRG+CHR PAYLOAD (CRC-32 AND SHA-1, HEADER LEFT OUT,
+     * AS ROM SETS DO, SO A COMPRESSED COPY HASHES THE SAME) AND WRITES ONE
+     * FIXED SIZE Entry PER ROM WITH THE PARSED HEADER. A FILE WHOSE PATH,
+     * SIZE AND MTIME MATCH THE PREVIOUS INDEX IS NOT OPENED AGAIN.
+     *
+     * Index MAPS THAT FILE AND ANSWERS LOOKUPS BY CRC-32, SHA-1 OR PATH WITH A
+     * BINARY SEARCH IN PLACE: NO ROM IS TOUCHED AND NOTHING IS PARSED, SO A
+     * TOOL PAYS THE SAME TO START ON TEN ROMS AS ON TEN THOUSAND.
+     *
+     * THE FILE, ALL LITTLE ENDIAN:
+     *
+     *   FileHeader
+     *   Entry    entries[count]    SORTED BY crc32, THEN sha1
+     *   uint32_t byName[count]     ENTRY NUMBERS SORTED BY PATH
+     *   uint32_t bySHA1[count]     ENTRY NUMBERS SORTED BY sha1
+     *   char     strings[]         ROOT DIRECTORY, THEN PATHS, NUL TERMINATED
+     */
+
+    static const uint32_t MAGIC   = 0x5443524E;     // "NRCT"
+    static const uint32_t VERSION = 1;
+
+    // Entry::flags
+    static const mos6502::i8 BATTERY     = 0x01;
+    static const mos6502::i8 TRAINER     = 0x02;
+    static const mos6502::i8 FOUR_SCREEN = 0x04;
+    static const mos6502::i8 NES2        = 0x08;
+
+    struct FileHeader{
+        uint32_t magic;
+        uint32_t version;
+        uint32_t count;
+        uint32_t entrySize;
+        uint64_t strings;       // OFFSET OF THE STRING TABLE
+        uint64_t stringsSize;
+        uint8_t  reserved[32];
+    };
+
+    struct Entry{
+        uint32_t    crc32;          // OF PRG+CHR, AS rom::ROM::getCRC32()
+        mos6502::i8 sha1[20];
+        uint64_t    size;           // OF THE FILE, AND ITS MTIME, TO SPOT CHANGES
+        int64_t     mtime;
+        uint32_t    path;           // INTO strings, RELATIVE TO THE ROOT
+        uint16_t    mapper;
+        uint16_t    prgBanks;       // 16 KB
+        uint16_t    chrBanks;       // 8 KB, 0 FOR CHR RAM
+        mos6502::i8 mirroring;      // 0 HORIZONTAL, 1 VERTICAL
+        mos6502::i8 flags;          // BATTERY, TRAINER, FOUR_SCREEN, NES2
+        mos6502::i8 tv;             // rom::TVSystem
+        mos6502::i8 header[5];      // FLAGS 6 TO 10 AS DUMPED
+        mos6502::i8 reserved[6];
+    };
+
+    // SCAN dir INTO THE INDEX FILE index (REPLACED ATOMICALLY) WITH threads
+    // WORKERS (0: ONE PER CORE). RETURNS THE NUMBER OF ROMS INDEXED, OR -1 IF
+    // dir CANNOT BE READ OR index CANNOT BE WRITTEN. log, IF GIVEN, GETS A
+    // LINE PER FILE THAT IS NOT A ROM AND A SUMMARY.
+    long build(const char *dir, const char *index, int threads = 0, std::ostream *log = NULL);
+
+    class Index{
+
+        private:
+
+            const mos6502::i8 *base;
+            size_t size;
+            const FileHeader *header;
+            const Entry *entries;
+            const uint32_t *byName;
+            const uint32_t *bySHA1;
+            const char *strings;
+
+            Index(const Index &);
+            Index &operator=(const Index &);
+
+        public:
+
+            Index();
+            ~Index();
+
+            // MAP AN INDEX WRITTEN BY build(). 0, OR -1 IF IT IS MISSING OR NOT
+            // ONE (A DIFFERENT VERSION INCLUDED).
+            int open(const char *path);
+            void close();
+
+            uint32_t count() const{return this->header ? this->header->count : 0;}
+            const Entry &at(uint32_t i) const{return this->entries[i];}
+
+            // NULL WHEN NOTHING MATCHES. SEVERAL FILES CAN HOLD THE SAME GAME:
+            // findCRC32() GIVES THE FIRST OF THEM, THE REST FOLLOW IT.
+            const Entry *findCRC32(uint32_t crc) const;
+            const Entry *findSHA1(const mos6502::i8 sha1[20]) const;
+            const Entry *findPath(const char *path) const;
+
+            const char *getRoot() const{return this->strings;}
+            const char *getPath(const Entry &entry) const{return this->strings + entry.path;}
+            // ROOT/PATH, READY FOR rom::ROM::loadNesFile().
+            std::string getFullPath(const Entry &entry) const;
+    };
+};
+
+#endif // !__CATALOG_H__
@@ -0,0 +1,119 @@
+#ifndef __CONFORM_H__
+#define __CONFORM_H__
+
+#include "MOS6502.h"
+#include "TRACE.h"
+#include "CPU.h"
+#include <istream>
+#include <string>
+
+namespace conform{
+
+    /**
+     * CPU CONFORMANCE AGAINST A GOLDEN LOG.
+     *
+     * THE CPU RUNS IN CHUNKS WITH A trace::BinaryTrace, AND AFTER EACH CHUNK
+     * EVERY INSTRUCTION IT EXECUTED IS COMPARED, AS IT WAS BEFORE IT RAN, WITH
+     * THE NEXT LINE OF THE LOG: PC, A, X, Y, P, SP AND THE CYCLE COUNT. THE
+     * LOG IS READ A LINE AT A TIME AS THE CPU GOES, SO ITS LENGTH DOES NOT
+     * MATTER, AND THE RUN STOPS AT THE FIRST LINE THAT DOES NOT MATCH.
+     *
+     * TWO LINE FORMATS ARE READ, WHICHEVER A LINE IS IN:
+     *
+     *   nestest.log    C000  4C F5 C5  JMP $C5F5    A:00 X:00 Y:00 P:24 SP:FD PPU:  0, 21 CYC:7
+     *   trace::format  PC:C000 OP:4C JMP C5F5 A:00 X:00 Y:00 P:24 SP:FD CYC:7
+     *
+     * OLD nestest.log FILES GIVE THE PPU DOT AS CYC (WITH SL:); THOSE LINES
+     * ARE CHECKED WITHOUT CYCLES. LINES WITH NEITHER FORMAT ARE SKIPPED. A LOG
+     * WRITTEN BY trace::TextTrace FROM A KNOWN GOOD BUILD IS A GOLDEN LOG TOO.
+     */
+
+    struct Line{
+        uint64_t     number;        // IN THE LOG, FROM 1
+        mos6502::i16 pc;
+        mos6502::i8  A;
+        mos6502::i8  X;
+        mos6502::i8  Y;
+        mos6502::i8  P;
+        mos6502::i8  SP;
+        bool         hasCycle;
+        uint64_t     cycle;
+        std::string  text;          // THE LINE AS WRITTEN
+    };
+
+    // STREAMING LOG PARSER.
+    class Reader{
+
+        private:
+
+            std::istream *in;
+            uint64_t number;
+
+        public:
+
+            Reader(std::istream &in);
+
+            // THE NEXT LINE IN EITHER FORMAT. FALSE AT THE END OF THE LOG.
+            bool next(Line &line);
+
+            // FILL line FROM text; FALSE IF IT IS IN NEITHER FORMAT.
+            static bool parse(const std::string &text, Line &line);
+    };
+
+    class Checker{
+
+        private:
+
+            Reader *reader;
+            Line expected;
+            bool ended;
+
+            // THE LAST FEW INSTRUCTIONS THAT MATCHED, FOR THE DIFF.
+            static const int CONTEXT = 8;
+            trace::Record recent[CONTEXT];
+            uint64_t matched;
+
+        public:
+
+            bool failed;
+            trace::Record got;          // THE INSTRUCTION THAT DIVERGED
+            bool checkCycles;
+
+            Checker(Reader &reader, bool checkCycles = true);
+
+            // COMPARE ONE EXECUTED INSTRUCTION WITH THE NEXT LOG LINE. FALSE
+            // ONCE IT, OR AN EARLIER ONE, DIVERGED OR THE LOG HAS ENDED.
+            inline bool check(const trace::Record &r){
+                if(this->failed || this->ended){
+                    return false;
+                }
+                const Line &e = this->expected;
+                if(r.pc != e.pc || r.A != e.A || r.X != e.X || r.Y != e.Y || r.P != e.P || r.SP != e.SP
+                   || (this->checkCycles && e.hasCycle && r.cycle != e.cycle)){
+                    this->got = r;
+                    this->failed = true;
+                    return false;
+                }
+                this->recent[this->matched % CONTEXT] = r;
+                this->matched++;
+                this->ended = !this->reader->next(this->expected);
+                return !this->ended;
+            }
+
+            // EVERY LOG LINE MATCHED.
+            bool done() const{return this->ended;}
+            bool stopped() const{return this->failed || this->ended;}
+            uint64_t getMatched() const{return this->matched;}
+            const Line &getExpected() const{return this->expected;}
+
+            // THE MATCHED CONTEXT, THEN EXPECTED AGAINST GOT WITH THE FIELDS
+            // THAT DIFFER MARKED.
+            void report(std::ostream &out) const;
+    };
+
+    // RUN cpu AGAINST THE LOG UNTIL IT DIVERGES, THE LOG ENDS OR limit
+    // INSTRUCTIONS HAVE MATCHED (0 FOR NO LIMIT). TRUE IF NOTHING DIVERGED.
+    bool run(cpu::CPU &cpu, Checker &checker, uint64_t limit = 0);
+};
+
+#endif // !__CONFORM_H__
@@ -2,21 +2,44 @@
 #define __CPU_H__
 
 #include "MOS6502.h"
-#include <map>
+#include "BUS.h"
+#include "BLOCK.h"
+#include "JIT.h"
+#include "STATE.h"
 #include <string>
 #include <vector>
+#include <string.h>
+
+namespace mapper{
+    class Mapper;
+};
+
+namespace lockstep{
+    class Engine;
+};
 
 namespace cpu
 {
-    class CPU
+    // POLLING LOOPS SKIPPED AND THE CYCLES CREDITED FOR THEM.
+    struct IdleStats{
+        uint64_t loops;
+        uint64_t cycles;
+    };
+
+    // THE REGISTERS LIVE IN THE STATE ARENA, SEE STATE.h. INHERITING IT KEEPS
+    // THEM PLAIN MEMBERS OF THE CPU (AND AT FIXED OFFSETS FOR THE JIT) WHILE
+    // THE WHOLE MACHINE STAYS ONE CONTIGUOUS BLOCK.
+    class CPU : private state::Machine
     {
-    
+        // THE JIT READS REGISTER OFFSETS AND HANDLERS STRAIGHT OFF THE CLASS.
+        friend class jit::Compiler;
+        // SO DOES THE LOCKSTEP ENGINE, FOR THE ADDRESSING MODES.
+        friend class lockstep::Engine;
+
     private:
             /**************************REGISTER**************************/
-            // SPECIAL-PURPOSE REGISTER
-            mos6502::i16 PC;
-            mos6502::i16 SP = 0XFF;    // 0X100 - 0X1FF , GROES DOWNWORDS.
-            mos6502::i8  P;               // PROCESSOR FLAG,BELOW ARE DETAILS:
+            // SPECIAL-PURPOSE REGISTER: PC, SP (0X100 - 0X1FF , GROES DOWNWORDS) AND
+            // P, THE PROCESSOR FLAG, BELOW ARE DETAILS:
                 mos6502::i8  CarryFlag              = 0x0; // (0x1<<0 & P)>>0;     // SET IF THE LAST INSTRACTION RESULTED IN AN OVER OR UNDERFLOW. 
                                                                                                 // USED FOR ARITHMETIC ON NUMBERS LARGER THAN ONE BYTE, 
                                                                                                 // WHERE THE NEXT INSTRACTION IS CRRAY-FLAG AWARE.
@@ -31,22 +54,36 @@ namespace cpu
                                                                                                 // MAKING THE RESULT A NEGATIVE
                 mos6502::i8  NegativeFlag          = 0x7; // (0x1<<7 & P)>>7;
 
-                mos6502::i8  isCarryFlag              = 0;
-                mos6502::i8  isZeroFlag               = 0;
-                mos6502::i8  isInterruptDisable    = 0x1;
-                mos6502::i8  isDecimalMode           = 0;                                    
-                mos6502::i8  isBreakCommand          = 0;
-                mos6502::i8  isUnusedBit              = 0;
-                mos6502::i8  isOverflowFlag          = 0;
-                mos6502::i8  isNegativeFlag          = 0;
-            // GRNERAL-PURPOSE REGISTER
-            mos6502::i8 A;       // ACCUULATOR, RELATED TO ALL ARITHMETIC RELATED INSTRACTIONS
-            mos6502::i8 X;       
-            mos6502::i8 Y;
+
+                // P ITSELF ONLY HOLDS I AND D. N/Z/C/V ARE LAZY: HANDLERS STORE WHAT
+                // THE FLAG DERIVES FROM AND getProcessorFlags() PACKS THEM ON DEMAND
+                // (BRANCHES, PHP, BRK, INTERRUPTS).
+                // N = BIT 7 OF flagN, Z = (flagZ == 0), C = BIT 8 OF flagC,
+                // V = BIT 7 OF (flagVA ^ flagVR) & (flagVM ^ flagVR), THE SIGNED
+                // OVERFLOW OF flagVA + flagVM = flagVR.
+
+                inline mos6502::i8 isNegative(){return this->flagN >> 7;}
+                inline mos6502::i8 isZero(){return this->flagZ == 0;}
+                inline mos6502::i8 isCarry(){return (this->flagC >> 8) & 0x1;}
+                inline mos6502::i8 isOverflow(){return ((this->flagVA ^ this->flagVR) & (this->flagVM ^ this->flagVR)) >> 7;}
+                inline void setNZ(mos6502::i8 value){this->flagN = value; this->flagZ = value;}
+            // GRNERAL-PURPOSE REGISTER: A, THE ACCUULATOR, RELATED TO ALL ARITHMETIC
+            // RELATED INSTRACTIONS, X AND Y.
 
             /**************************MEMORY **************************/
             // THE NES HAS A 16 BIT ADDRESS BUS, CAN ADDRESS UP TO 16 KB OF MEMORY, FROM 0X0000 TO 0XFFFF. 
-            mos6502::i8 *memory;
+            // ALL ACCESSES GO THROUGH THE PAGE TABLE OF THE BUS, SEE BUS.h.
+            bus::Bus bus;
+
+            // PRE-DECODED CODE, SEE BLOCK.h.
+            block::Cache blocks;
+
+            // NATIVE TIER FOR HOT BLOCKS, SEE JIT.h. OFF UNTIL setJit(true).
+            jit::Compiler jit;
+            bool jitEnabled = false;
+
+            // BANK SWITCHING, SEE MAPPER.h. NULL WITHOUT A CARTRIDGE.
+            mapper::Mapper *mapper = NULL;
             // ADDRESS
             mos6502::i16 zeroPage              = 0x0;
             mos6502::i16 stack                  = 0x1FF;   // 0X100 TO 0X1FF, THE SP WILLA WRAP IF IT EXCEEDS ITS CAPACITY.
@@ -60,7 +97,9 @@ namespace cpu
             mos6502::i16 paks                    = 0x8000; // 0X8000, IF THE PROGRAM ONLY CONTAINS ONE BANK, IT WILL BE MIRRORED AT 0XC000.
             mos6502::i16 mirrorOf0x8000       = 0xC000; // 0XC000, MIRROR OF PAKS
 
+            mos6502::i16 nmiVector             = 0xFFFA;
             mos6502::i16 resetVector           = 0xFFFC;
+            mos6502::i16 irqVector             = 0xFFFE;
 
             /**************************INTERRUPT**************************/
             mos6502::i16 IRQ;
@@ -68,6 +107,24 @@ namespace cpu
             mos6502::i16 Reset;
 
             mos6502::i8 running;
+
+            // IDLE LOOP FAST-FORWARD, SEE idle(). nextEvent IS THE MASTER CLOCK AT
+            // WHICH runCycles() HANDS CONTROL BACK FOR THE NEXT SCHEDULED EVENT
+            // (VBLANK, IRQ, DMA), 0 WHEN NOT SKIPPING.
+            uint64_t nextEvent = 0;
+            bool idleSkip = true;
+            struct IdleProbe{
+                bool         armed;
+                mos6502::i16 pc;
+                mos6502::i8  A, X, Y, P;
+                mos6502::i16 SP;
+                uint64_t     cycle;
+            } probe = {false, 0, 0, 0, 0, 0, 0, 0};
+            IdleStats idleStats = {0, 0};
+
+            // THE MASTER CLOCK (cycles) IS CPU CYCLES SINCE POWER-ON, BASE COST PLUS
+            // PAGE-CROSS, BRANCH AND INTERRUPT PENALTIES. NEVER WRAPS IN PRACTICE
+            // (~325K YEARS).
             /**************************ADDRESS MODE **************************/
             typedef enum AddressingMode{
                 IMPLICIT,
@@ -164,46 +221,159 @@ namespace cpu
             mos6502::i16 AXS(mos6502::i16 op);
             mos6502::i16 SHY(mos6502::i16 op);
             mos6502::i16 AHX(mos6502::i16 op);
+            mos6502::i16 ARR(mos6502::i16 op);
+            mos6502::i16 SHX(mos6502::i16 op);
                 
             
-            void initOpTable();
+            // SHARED BODIES OF THE ARITHMETIC, COMPARE, BRANCH AND STACK HANDLERS.
+            void adc(mos6502::i8 value);
+            void compare(mos6502::i8 reg, mos6502::i8 value);
+            void branch(mos6502::i8 condition);
+            mos6502::i8 shiftLeft(mos6502::i8 value, mos6502::i8 carryIn);
+            mos6502::i8 shiftRight(mos6502::i8 value, mos6502::i8 carryIn);
+            void push(mos6502::i8 value);
+            mos6502::i8 pull();
+            void push16(mos6502::i16 value);
+            mos6502::i16 pull16();
+            mos6502::i16 read16(mos6502::i16 addr);
+            mos6502::i16 pageCross(mos6502::i16 base, mos6502::i16 addr);
+            void interrupt(mos6502::i16 vector, mos6502::i8 breakFlag);
+            void idle();
+            inline uint32_t endRun(uint64_t start){
+                this->nextEvent = 0;
+                this->probe.armed = false;
+                return this->cycles - start;
+            }
+
+            // PLAIN FUNCTION ENTRY POINTS FOR EVERY HANDLER, CALLED FROM NATIVE CODE.
+            typedef void (*Thunk)(CPU *cpu);
+            static const Thunk thunks[256];
+
+            // RUN THE NATIVE CODE OF THE BLOCK AT PC IF THERE IS (OR NOW IS) ANY
+            // AND IT IS SURE TO FINISH BY end, SO THE TIER NEVER MOVES A RUN'S END.
+            bool runNative(uint64_t end);
+
+            // HAND THE DECODED INSTRUCTION AND PRE-EXECUTION REGISTERS TO A TRACE POLICY.
+            template<class Trace> inline void traceStep(Trace &tracer){
+                tracer.record(this->opPC, this->opINS->op, this->operand,
+                              this->A, this->X, this->Y, this->getProcessorFlags(), (mos6502::i8)this->SP,
+                              this->cycles);
+            }
+
     public:
         CPU();
+
+        // THE STATE ARENA IS CACHE LINE ALIGNED, WHICH PLAIN new ONLY HONOURS FROM C++17.
+        static void *operator new(size_t size);
+        static void operator delete(void *memory);
         
         typedef mos6502::i16 (CPU::*opHandler)(mos6502::i16); // pointer to CPU's member function.
+
+        // COMPACT OPCODE DESCRIPTOR, PADDED TO 32 BYTES SO TWO OF THEM SHARE A
+        // CACHE LINE AND NONE STRADDLES ONE. NAMES LIVE IN THE COLD opNames TABLE.
         struct OpINS{
+            mos6502::i16 (CPU::*opHandler)(mos6502::i16);
             mos6502::i8 op;
-            AddressingMode addrMode;
-            std::string opName;
+            mos6502::i8 addrMode;
             mos6502::i8 bytes;
             mos6502::i8 cycles;
-            mos6502::i16 (CPU::*opHandler)(mos6502::i16);
-            mos6502::i8 *value;
+            mos6502::i8 pageCross;    // +1 CYCLE WHEN THE EFFECTIVE ADDRESS CROSSES A PAGE
+            mos6502::i8 padding[32 - sizeof(opHandler) - 5];
         };
         typedef struct OpINS OpINS;
-        std::map<mos6502::i16,OpINS> opHandlerTable;      // op handler map
-        OpINS opINS;
+
+        static const OpINS opTable[256];            // DENSE DISPATCH TABLE, INDEXED BY OPCODE
+        static const char *const opNames[256];      // MNEMONICS, ONLY USED FOR TRACING
+        const OpINS *opINS;                         // DESCRIPTOR OF THE DECODED INSTRUCTION
+        mos6502::i16 operand;                       // OPERAND BYTES OF THE DECODED INSTRUCTION
+        mos6502::i16 opPC;                          // ADDRESS OF THE DECODED INSTRUCTION
+
+        // NTSC 2A03: 1.789773 MHZ / 60.0988 HZ
+        static const uint32_t CYCLES_PER_FRAME = 29781;
+        // THE 20 VBLANK SCANLINES OF 341 PPU DOTS, 3 DOTS A CPU CYCLE.
+        static const uint32_t VBLANK_CYCLES = 20 * 341 / 3;
 
         mos6502::i8 setFlag(mos6502::i8 flag);
         mos6502::i8 getFlag(mos6502::i8 flag);
         mos6502::i8 reset();
+        void flushBlocks();
         mos6502::i8 getProcessorFlags();
+        void setProcessorFlags(mos6502::i8 flags);
+
+        // HARDWARE INTERRUPTS, TAKEN BETWEEN INSTRUCTIONS. RETURN THE CYCLES CHARGED TO
+        // THE MASTER CLOCK (7, OR 0 FOR AN irq() MASKED BY I).
+        mos6502::i8 nmi();
+        mos6502::i8 irq();
        
+        mos6502::i16 effectiveAddress(mos6502::i16 addr);
         mos6502::i16 readWithAddrMode(mos6502::i16 addr);
         mos6502::i16 writeWithAddrMode(mos6502::i16 addr,mos6502::i8 value);
 
-        void setPRG1(std::vector<mos6502::i8> prg);
-        void setPRG2(std::vector<mos6502::i8> chr);
+        // COPY UP TO 16 KB OF PRG TO $8000 / $C000 OF THE BUS'S OWN WINDOW, FOR
+        // BARE CPUS. A CARTRIDGE MAPS ITS BANKS THROUGH A mapper::Mapper INSTEAD.
+        void setPRG1(const mos6502::i8 *prg, size_t size);
+        void setPRG2(const mos6502::i8 *prg, size_t size);
 
-        OpINS getOpHandler(mos6502::i16 op);
+        const OpINS &getOpHandler(mos6502::i8 op);
+        const char *getOpName(mos6502::i8 op);
 
         mos6502::i8  write(mos6502::i16 addr, mos6502::i8 data);
         mos6502::i8 read(mos6502::i16 addr);
 
         mos6502::i16 fetch();
         mos6502::i16 decode();
+        mos6502::i16 decodeFromBus();
         mos6502::i16 execute();
-        
+        mos6502::i16 step();
+
+        // BATCH EXECUTION. RETURN THE CYCLES ACTUALLY SPENT (PENALTIES INCLUDED),
+        // WHICH MAY OVERSHOOT THE BUDGET BY THE TAIL OF THE LAST INSTRUCTION.
+        // THE Trace POLICY (trace::NoTrace, BinaryTrace, TextTrace) IS CALLED
+        // ONCE PER INSTRUCTION; NoTrace COMPILES AWAY.
+        template<class Trace> uint32_t runCycles(uint32_t budget, Trace &tracer);
+        uint32_t runCycles(uint32_t budget);
+
+        // ONE NTSC FRAME, OPENING WITH VBLANK: PPUSTATUS BIT 7 IS RAISED (AND AN
+        // NMI TAKEN IF PPUCTRL ENABLES IT) FOR VBLANK_CYCLES, THEN DROPPED FOR THE
+        // REST. THE PPU DOES NOT KEEP TIME YET, SO THIS STANDS IN FOR IT. THE
+        // Trace POLICY IS HANDED TO runCycles().
+        template<class Trace> uint32_t runFrame(Trace &tracer);
+        uint32_t runFrame();
+
+        mos6502::i16 readResetVector();
+        mos6502::i16 getPC(){return this->PC;}
+        void setPC(mos6502::i16 pc){this->PC = pc;}
+        uint64_t getCycles(){return this->cycles;}
+        bus::Bus &getBus(){return this->bus;}
+        state::Pads &getPads(){return this->pads;}
+        state::Cart &getCart(){return this->cart;}
+
+        // THE CARTRIDGE'S MAPPER, WHICH ATTACHES ITSELF (SEE MAPPER.h). loadState()
+        // HAS IT MAP THE BANKS THE SNAPSHOT HOLDS. NULL: THE BUS'S OWN PRG WINDOW.
+        void setMapper(mapper::Mapper *mapper){this->mapper = mapper;}
+        mapper::Mapper *getMapper(){return this->mapper;}
+
+        // SNAPSHOTS. SAVING IS ONE COPY OF THE ARENA; LOADING IS ONE COPY BACK,
+        // PLUS DROPPING BLOCKS DECODED FROM RAM/SRAM, WHICH MAY NOW HOLD OTHER CODE,
+        // AND REMAPPING THE PRG BANKS THE SNAPSHOT HAD SELECTED.
+        const state::Machine &getState(){return *this;}
+        void saveState(state::Machine &machine){memcpy(&machine, (state::Machine *)this, sizeof(machine));}
+        void loadState(const state::Machine &machine);
+        block::Cache &getBlockCache(){return this->blocks;}
+        const block::Stats &getBlockStats(){return this->blocks.getStats();}
+
+        // CAN op SIT IN A POLLING LOOP: NO WRITES, NO STACK, ONLY READS OF PLAIN
+        // MEMORY OR PPUSTATUS, WHOSE REPEATED READS ARE IDEMPOTENT.
+        static bool isPollSafe(mos6502::i8 op, mos6502::i16 operand, bus::Bus &bus);
+
+        // IDLE LOOP SKIPPING IN runCycles<NoTrace>(), ON BY DEFAULT.
+        void setIdleSkip(bool enabled){this->idleSkip = enabled;}
+        const IdleStats &getIdleStats(){return this->idleStats;}
+
+        // TURN THE JIT TIER ON/OFF. RETURNS WHETHER IT IS NOW ON, WHICH IS NEVER
+        // THE CASE WITHOUT HAVE_JIT. ONLY runCycles() WITH trace::NoTrace USES IT.
+        bool setJit(bool enabled);
+        const jit::Stats &getJitStats(){return this->jit.getStats();}
         mos6502::i16 run();
 
         ~CPU();
@@ -0,0 +1,144 @@
+#ifndef __ENV_H__
+#define __ENV_H__
+
+#include "MOS6502.h"
+#include "NES.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace env{
+
+    /**
+     * SHARED-MEMORY ENVIRONMENT SERVER.
+     *
+     * A SERVER PROCESS HOSTS instances MACHINES (nes::NES) ON ONE ROM AND
+     * SHARES ONE POSIX SHARED-MEMORY REGION, /dev/shm/<name>, WITH A CLIENT:
+     *
+     *     PAGE 0         Control: GEOMETRY AND THE TWO SEQUENCE WORDS
+     *     PAGE 1 ...     ONE Slot PER INSTANCE, EACH ON ITS OWN PAGES
+     *
+     * ONE ROUND TRIP: THE CLIENT WRITES THE INPUTS (AND RESET FLAGS) OF EVERY
+     * SLOT AND BUMPS request. EACH SERVER WORKER SEES THE NEW request, STEPS
+     * ITS SHARE OF THE INSTANCES BY ONE FRAME AND PUBLISHES THEIR RAM AND
+     * FRAMEBUFFER INTO THEIR SLOTS; THE LAST WORKER TO FINISH SETS response TO
+     * request. THE CLIENT THEN READS THE OBSERVATIONS WHERE THEY LIE. THERE
+     * IS NO SOCKET, NO MESSAGE AND NO SERIALIZATION IN THE DATA PATH.
+     *
+     * WAITING IS A SHORT SPIN ON THE SEQUENCE WORD, THEN A FUTEX WAIT ON IT
+     * (SHARED, NOT PRIVATE, SO IT WORKS ACROSS THE TWO PROCESSES); EACH BUMP IS
+     * FOLLOWED BY A FUTEX WAKE. WITHOUT FUTEXES (NOT LINUX) THE WAIT YIELDS.
+     *
+     * THE RING IS ONE ENTRY DEEP: OBSERVATIONS ARE PUBLISHED IN PLACE, SO THE
+     * CLIENT OWNS THE SLOTS FROM response TO ITS NEXT request AND THE SERVER
+     * FROM request TO response. ONE CLIENT AT A TIME.
+     *
+     * ram IS COPIED OUT OF THE MACHINE EVERY STEP (2 KB); THE FRAMEBUFFER ONLY
+     * WHEN THE PPU REPORTS A NEW PICTURE (frameVersion CHANGES).
+     */
+
+    static const uint32_t MAGIC   = 0x5645454E;     // "NEEV"
+    static const uint32_t VERSION = 1;
+    static const size_t   PAGE    = 4096;
+
+    struct Control{
+        uint32_t magic;                 // WRITTEN LAST: NONZERO ONCE THE SERVER IS UP
+        uint32_t version;
+        uint32_t instances;
+        uint32_t slotSize;              // BYTES FROM ONE Slot TO THE NEXT
+        uint32_t width;
+        uint32_t height;
+        uint32_t ramSize;
+        uint32_t workers;
+        mos6502::i8 padding0[32];
+
+        // EACH SIDE WRITES ITS OWN CACHE LINE.
+        std::atomic<uint32_t> request;  // BUMPED BY THE CLIENT
+        mos6502::i8 padding1[60];
+        std::atomic<uint32_t> response; // SET TO request BY THE SERVER WHEN DONE
+        std::atomic<uint32_t> pending;  // WORKERS STILL STEPPING request
+        std::atomic<uint32_t> stop;     // NONZERO: SERVER GONE OR GOING
+        mos6502::i8 padding2[52];
+    };
+
+    struct Slot{
+        // WRITTEN BY THE CLIENT BEFORE A STEP.
+        mos6502::i8 input[2];           // nes::JoyPads::Button MASKS, PORT 0 AND 1
+        mos6502::i8 reset;              // NONZERO: POWER CYCLE BEFORE THIS STEP (SERVER CLEARS)
+        mos6502::i8 padding0[61];
+
+        // WRITTEN BY THE SERVER DURING ONE.
+        uint64_t frame;                 // FRAMES SINCE POWER ON
+        uint64_t cycles;
+        uint32_t frameVersion;
+        mos6502::i8 padding1[44];
+        mos6502::i8 ram[0x800];
+        mos6502::i8 framebuffer[nes::NES::WIDTH * nes::NES::HEIGHT];
+    };
+
+    static_assert(sizeof(Control) == 192 && sizeof(Control) <= PAGE, "env::Control layout");
+    static_assert(sizeof(Slot) % 64 == 0, "env::Slot layout");
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && ATOMIC_INT_LOCK_FREE == 2,
+                  "futex words must be plain lock-free 32 bit atomics");
+
+    class Server{
+
+        private:
+
+            std::string name;
+            Control *control;
+            size_t size;
+            std::vector<std::unique_ptr<nes::NES> > machines;
+
+            Slot *getSlot(size_t i){return (Slot *)((mos6502::i8 *)this->control + PAGE + i * this->control->slotSize);}
+            void publish(size_t i);
+            void work(int worker);
+
+        public:
+
+            Server();
+
+            // CREATE /dev/shm/<name> (REPLACING A STALE ONE) AND LOAD rom INTO
+            // instances MACHINES SERVED BY workers THREADS (0 FOR ONE PER
+            // HARDWARE THREAD). 0 ON SUCCESS, -1 OTHERWISE.
+            int open(const char *name, const char *rom, uint32_t instances, int workers = 0);
+
+            // SERVE ROUND TRIPS UNTIL stop(). RETURNS THE ROUND TRIPS SERVED.
+            uint64_t run();
+
+            // END run() AND TELL THE CLIENT. ASYNC SIGNAL SAFE.
+            void stop();
+
+            ~Server();
+    };
+
+    class Client{
+
+        private:
+
+            Control *control;
+            size_t size;
+
+        public:
+
+            Client();
+
+            // MAP THE REGION OF A RUNNING SERVER. -1 IF THERE IS NONE (YET).
+            int open(const char *name);
+
+            uint32_t getInstances() const{return this->control->instances;}
+            Slot *getSlot(size_t i){return (Slot *)((mos6502::i8 *)this->control + PAGE + i * this->control->slotSize);}
+
+            // ONE ROUND TRIP: EVERY INSTANCE RUNS ONE FRAME WITH ITS SLOT'S INPUT.
+            // 0 ON SUCCESS, -1 IF THE SERVER HAS STOPPED.
+            int step();
+
+            // ASK THE SERVER TO EXIT.
+            void shutdown();
+
+            ~Client();
+    };
+};
+
+#endif // !__ENV_H__
@@ -0,0 +1,96 @@
+#ifndef __JIT_H__
+#define __JIT_H__
+
+#include "MOS6502.h"
+#include "BLOCK.h"
+#include <stddef.h>
+
+// THE NATIVE TIER ONLY EXISTS FOR X86-64 LINUX. BUILD WITH -D NO_JIT TO DROP IT.
+#if defined(__x86_64__) && defined(__linux__) && !defined(NO_JIT)
+    #define HAVE_JIT 1
+#endif
+
+namespace jit{
+
+    /**
+     * X86-64 TIER FOR HOT BASIC BLOCKS.
+     *
+     * A BLOCK FROM THE BLOCK CACHE THAT WAS ENTERED THRESHOLD TIMES IS
+     * TRANSLATED INTO ONE NATIVE FUNCTION IN AN MMAP'ED ARENA. THE
+     * FUNCTION CHARGES THE BLOCK'S BASE CYCLES ONCE, DOES SIMPLE REGISTER OPS
+     * (LOADS, TRANSFERS, INC/DEC, CLC/SEC) INLINE ON THE CPU STRUCT, AND CALLS
+     * THE INTERPRETER HANDLER FOR EVERYTHING ELSE, WITH PC/OPERAND/opINS SET UP
+     * AS decode() WOULD. PENALTIES ARE STILL ADDED BY THE HANDLERS.
+     *
+     * THE CPU ONLY CHECKS BUDGET AND INTERRUPTS BETWEEN BLOCKS, SO A BLOCK ALSO
+     * RECORDS ITS WORST CASE CYCLES (EVERY PAGE CROSS, EVERY BRANCH TAKEN TO A
+     * NEW PAGE) AND IS ONLY ENTERED WHEN THE BUDGET LEFT COVERS THEM; A RUN THEN
+     * ENDS ON THE SAME CYCLE AS IN THE INTERPRETER. STAYING CORRECT IS LEFT TO
+     * THE INTERPRETER:
+     *   - BLOCKS IN RAM/SRAM (SELF-MODIFYING CODE) ARE NEVER COMPILED.
+     *   - MMIO PAGES ARE NEVER CACHED, SO NEVER COMPILED.
+     *   - A BLOCK IS CUT AFTER THE FIRST STORE THAT MAY HIT A HANDLER PAGE
+     *     (MAPPER REGISTERS CAN SWITCH THE BANK THE BLOCK RUNS FROM); THE REST
+     *     OF IT RUNS INTERPRETED.
+     *   - KIL IS NEVER COMPILED.
+     *
+     * WHEN THE ARENA IS FULL IT IS RECYCLED WHOLE AND BLOCKS RECOMPILE AS THEY
+     * GET HOT AGAIN.
+     *
+     * THE ARENA IS NEVER WRITABLE AND EXECUTABLE AT ONCE: IT IS ONLY RW WHILE
+     * compile() EMITS AND IS FLIPPED BACK TO RX BEFORE IT RETURNS.
+     * WHERE THE KERNEL REFUSES EXECUTABLE ANONYMOUS MEMORY THE COMPILER FAILS
+     * FOR GOOD AND THE CPU STAYS IN THE INTERPRETER.
+     */
+
+    static const int THRESHOLD      = 64;           // BLOCK ENTRIES BEFORE COMPILING
+    static const size_t ARENA_SIZE  = 1 << 20;
+    static const size_t MAX_BLOCK   = 2048;         // WORST CASE CODE FOR ONE BLOCK
+
+    struct Stats{
+        uint64_t compiled;          // BLOCKS TRANSLATED
+        uint64_t rejected;          // HOT BLOCKS THAT COULD NOT BE TRANSLATED
+        uint64_t runs;              // NATIVE BLOCK EXECUTIONS
+        uint64_t recycles;          // TIMES THE ARENA WAS THROWN AWAY
+        uint64_t bytes;             // CODE BYTES IN THE ARENA NOW
+    };
+
+    class Compiler{
+
+        private:
+
+            mos6502::i8 *arena;
+            size_t used;
+            bool failed;            // MMAP/MPROTECT REFUSED, STAY IN THE INTERPRETER
+            Stats stats;
+
+            static bool mayRemap(cpu::CPU &cpu, mos6502::i8 op, mos6502::i16 operand);
+            bool setWritable(bool writable);
+
+        public:
+
+            Compiler();
+
+            // TRUE IF THIS BUILD AND HOST CAN RUN NATIVE CODE.
+            bool available();
+
+            // TRANSLATE A PREFIX OF block. FALSE IF NOTHING COULD BE TRANSLATED,
+            // THE ARENA IS FULL (SEE full()) OR IT COULD NOT BE MADE EXECUTABLE
+            // (SEE available(); THE CALLER MUST THEN DROP EVERY NATIVE POINTER).
+            bool compile(block::Block &block, cpu::CPU &cpu);
+
+            bool full(){return this->used + MAX_BLOCK > ARENA_SIZE;}
+
+            // START OVER WITH AN EMPTY ARENA. THE CALLER MUST DROP EVERY NATIVE
+            // POINTER FIRST (block::Cache::dropNative()).
+            void recycle();
+
+            inline void ran(){this->stats.runs++;}
+            const Stats &getStats() const{return this->stats;}
+
+            ~Compiler();
+    };
+
+};
+
+#endif // !__JIT_H__
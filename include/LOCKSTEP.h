@@ -0,0 +1,247 @@
+#ifndef __LOCKSTEP_H__
+#define __LOCKSTEP_H__
+
+#include "MOS6502.h"
+#include "CPU.h"
+#include <vector>
+
+namespace lockstep{
+
+    /**
+     * LOCKSTEP ENGINE FOR N COPIES OF ONE ROM.
+     *
+     * EVERY LANE IS A WHOLE MACHINE AS cpu::CPU SEES IT (REGISTERS, 2 KB RAM,
+     * 8 KB SRAM, PPU AND IO LATCHES, THE TWO PADS OF nes::JoyPads), STORED STRUCTURE-OF-ARRAYS: ONE ARRAY PER
+     * REGISTER, AND ONE ROW OF N BYTES PER MEMORY ADDRESS, SO THE SAME ADDRESS
+     * OF CONSECUTIVE LANES IS CONTIGUOUS. PRG IS SHARED READ-ONLY BY ALL LANES.
+     *
+     * EACH STEP EXECUTES ONE INSTRUCTION ON EVERY LANE THAT IS STILL INSIDE
+     * ITS BUDGET. LANES ARE GROUPED BY PC: A GROUP IN PRG RUNS ONE OPCODE WITH
+     * ONE OPERAND, SO FOR THE COMMON CLASSES (LOADS, STORES, ALU, COMPARE,
+     * INC/DEC, TRANSFERS, FLAGS, BRANCHES, JMP) WITH IMMEDIATE, ZERO PAGE OR
+     * ABSOLUTE OPERANDS IT IS EXECUTED VEC LANES AT A TIME WITH SSE2 (OR AVX2
+     * WITH -mavx2) KERNELS, LANES OUTSIDE THE GROUP MASKED OFF. EVERYTHING ELSE
+     * (INDEXED/INDIRECT MODES, STACK, ADC/SBC, SHIFTS, UNOFFICIAL OPCODES, CODE
+     * IN RAM) RUNS LANE BY LANE THROUGH A SCALAR CORE THAT MIRRORS cpu::CPU'S
+     * HANDLERS, CYCLE PENALTIES INCLUDED. DIVERGED LANES COST ONE GROUP EACH.
+     *
+     * FLAGS ARE KEPT PACKED (NV-BDIZC, B CLEAR, BIT 5 SET) RATHER THAN LAZY, SO
+     * THE KERNELS CAN UPDATE THEM WITH PLAIN BYTE OPERATIONS.
+     */
+
+    static const int VEC = 32;                  // LANES PER KERNEL ITERATION, A MULTIPLE OF EVERY VECTOR WIDTH
+
+    struct Stats{
+        uint64_t steps;             // INSTRUCTIONS PER ACTIVE LANE, I.E. LOCKSTEP ROUNDS
+        uint64_t groups;            // DISTINCT PCS EXECUTED OVER ALL ROUNDS
+        uint64_t vectorLanes;       // LANE-INSTRUCTIONS RUN BY THE KERNELS
+        uint64_t scalarLanes;       // LANE-INSTRUCTIONS RUN BY THE SCALAR CORE
+    };
+
+    class Engine{
+
+        private:
+
+            typedef cpu::CPU::OpINS OpINS;
+
+            int count;              // LANES ASKED FOR
+            int lanes;              // ROUNDED UP TO VEC, THE REST NEVER RUN
+
+            // REGISTERS, ONE ENTRY PER LANE.
+            std::vector<mos6502::i8>  A, X, Y, SP, P;
+            std::vector<mos6502::i16> PC;
+            std::vector<uint64_t>     cycles;
+            std::vector<uint64_t>     end;
+            std::vector<uint32_t>     overshoot;
+
+            // MEMORY, ROW-MAJOR BY ADDRESS: BYTE addr OF LANE l IS [addr * lanes + l].
+            std::vector<mos6502::i8> ram;
+            std::vector<mos6502::i8> sram;
+            std::vector<mos6502::i8> ppuLatch;
+            std::vector<mos6502::i8> ioLatch;
+            mos6502::i8 prg[0x8000];
+
+            // CONTROLLERS AS IN state::Pads: BUTTONS AND SHIFT OF PORT p FOR LANE l
+            // ARE [p * lanes + l], THE STROBE IS ONE PER LANE.
+            std::vector<mos6502::i8> padButtons;
+            std::vector<mos6502::i8> padShift;
+            std::vector<mos6502::i8> padStrobe;
+
+            // SCRATCH MASKS FOR ONE ROUND, 0XFF PER LANE.
+            std::vector<mos6502::i8> todo;
+            std::vector<mos6502::i8> group;
+
+            Stats stats;
+
+            // THE INSTRUCTION THE SCALAR CORE IS EXECUTING.
+            const OpINS *opINS;
+            mos6502::i16 operand;
+            mos6502::i16 opPC;
+
+            // ROW OF addr FOR LANE MEMORY, NULL FOR PRG, OPEN BUS AND IGNORED WRITES.
+            mos6502::i8 *readRow(mos6502::i16 addr);
+            mos6502::i8 *writeRow(mos6502::i16 addr);
+            mos6502::i8 shared(mos6502::i16 addr);
+
+            // $4016/$4017 OF ONE LANE, SAME SEMANTICS AS nes::JoyPads.
+            mos6502::i8 readPad(int l, mos6502::i16 addr);
+            void writeStrobe(int l, mos6502::i8 data);
+
+            inline mos6502::i8 read(int l, mos6502::i16 addr){
+                if((addr & 0xFFFE) == 0x4016){
+                    return this->readPad(l, addr);
+                }
+                mos6502::i8 *row = this->readRow(addr);
+                return row ? row[l] : this->shared(addr);
+            }
+            inline void write(int l, mos6502::i16 addr, mos6502::i8 data){
+                if(addr == 0x4016){
+                    this->writeStrobe(l, data);
+                    return;
+                }
+                mos6502::i8 *row = this->writeRow(addr);
+                if(row){
+                    row[l] = data;
+                }
+            }
+
+            // SCALAR CORE.
+            void stepLane(int l);
+            void setNZ(int l, mos6502::i8 value);
+            void setFlag(int l, mos6502::i8 mask, bool on);
+            mos6502::i16 effectiveAddress(int l);
+            mos6502::i16 pageCross(int l, mos6502::i16 base, mos6502::i16 addr);
+            mos6502::i8 readOperand(int l);
+            void writeOperand(int l, mos6502::i8 value);
+            void adc(int l, mos6502::i8 value);
+            void compare(int l, mos6502::i8 reg, mos6502::i8 value);
+            void branch(int l, bool condition);
+            void push(int l, mos6502::i8 value);
+            mos6502::i8 pull(int l);
+            void interrupt(int l, mos6502::i16 vector, mos6502::i8 breakFlag);
+
+            // ONE PER cpu::CPU HANDLER, SAME NAMES AND SEMANTICS.
+            void ADC(int l);
+            void SBC(int l);
+            void AND(int l);
+            void EOR(int l);
+            void ORA(int l);
+            void ASL(int l);
+            void LSR(int l);
+            void ROL(int l);
+            void ROR(int l);
+            void BCC(int l);
+            void BCS(int l);
+            void BEQ(int l);
+            void BNE(int l);
+            void BIT(int l);
+            void BMI(int l);
+            void BPL(int l);
+            void BRK(int l);
+            void BVC(int l);
+            void BVS(int l);
+            void CLC(int l);
+            void SEC(int l);
+            void CLD(int l);
+            void SED(int l);
+            void CLI(int l);
+            void SEI(int l);
+            void CLV(int l);
+            void CMP(int l);
+            void CPX(int l);
+            void CPY(int l);
+            void DEC(int l);
+            void DEX(int l);
+            void DEY(int l);
+            void INC(int l);
+            void INX(int l);
+            void INY(int l);
+            void JMP(int l);
+            void JSR(int l);
+            void RTS(int l);
+            void LDA(int l);
+            void LDX(int l);
+            void LDY(int l);
+            void NOP(int l);
+            void PHA(int l);
+            void PLA(int l);
+            void PHP(int l);
+            void PLP(int l);
+            void RTI(int l);
+            void STA(int l);
+            void STX(int l);
+            void STY(int l);
+            void TAX(int l);
+            void TXA(int l);
+            void TYA(int l);
+            void TAY(int l);
+            void TSX(int l);
+            void TXS(int l);
+            // UNOFFICIAL
+            void KIL(int l);
+            void SLO(int l);
+            void RLA(int l);
+            void SRE(int l);
+            void RRA(int l);
+            void SAX(int l);
+            void LAX(int l);
+            void DCP(int l);
+            void ISC(int l);
+            void ANC(int l);
+            void ALR(int l);
+            void XAA(int l);
+            void TAS(int l);
+            void LAS(int l);
+            void AXS(int l);
+            void SHY(int l);
+            void AHX(int l);
+            void ARR(int l);
+            void SHX(int l);
+
+            // RUN THE GROUP THROUGH A KERNEL. FALSE IF THERE IS NONE FOR ins.
+            bool stepGroup(const OpINS &ins, mos6502::i16 pc, mos6502::i16 operand, int first);
+
+            // RUN EVERY LANE UP TO ITS end.
+            void run();
+
+        public:
+
+            Engine(int count);
+
+            // SHARE ONE 32 KB PRG WINDOW ($8000-$FFFF) BETWEEN ALL LANES.
+            void setPRG(const mos6502::i8 *prg);
+
+            // POWER ON EVERY LANE THE WAY cpu::CPU::reset() + readResetVector() DO.
+            void reset();
+
+            // RUN EVERY LANE FOR budget CYCLES OF ITS OWN CLOCK, OR ONE NTSC
+            // FRAME WITH VBLANK AND THE OVERSHOOT CARRIED OVER LIKE
+            // cpu::CPU::runFrame().
+            void runCycles(uint32_t budget);
+            void runFrame();
+
+            void nmi();
+            void irq();
+
+            // PER LANE ACCESS. setInput() IS nes::JoyPads::set() FOR LANE l.
+            void setInput(int l, int port, mos6502::i8 buttons);
+            mos6502::i8  peek(int l, mos6502::i16 addr){return this->read(l, addr);}
+            void poke(int l, mos6502::i16 addr, mos6502::i8 data){this->write(l, addr, data);}
+            mos6502::i8  getA(int l){return this->A[l];}
+            mos6502::i8  getX(int l){return this->X[l];}
+            mos6502::i8  getY(int l){return this->Y[l];}
+            mos6502::i8  getP(int l){return this->P[l];}
+            mos6502::i8  getSP(int l){return this->SP[l];}
+            mos6502::i16 getPC(int l){return this->PC[l];}
+            uint64_t     getCycles(int l){return this->cycles[l];}
+
+            int getLanes() const{return this->count;}
+            const Stats &getStats() const{return this->stats;}
+            void resetStats();
+
+            ~Engine();
+    };
+
+};
+
+#endif // !__LOCKSTEP_H__
@@ -0,0 +1,122 @@
+#ifndef __MAPPER_H__
+#define __MAPPER_H__
+
+#include "MOS6502.h"
+#include "ROM.h"
+#include "STATE.h"
+
+namespace cpu{
+    class CPU;
+};
+
+namespace mapper{
+
+    /**
+     * CARTRIDGE MAPPERS.
+     *
+     * A MAPPER OWNS THE CPU'S $8000-$FFFF: READS GO STRAIGHT THROUGH THE BUS
+     * PAGE TABLE INTO THE ROM IMAGE (MAPPED FROM THE FILE, SEE ROM.h), WRITES
+     * REACH write() THROUGH THE BUS HANDLER. A BANK SWITCH POINTS THE 32 PAGES
+     * OF AN 8 KB SLOT AT ANOTHER PART OF THE IMAGE, SO NOTHING IS COPIED
+     * HOWEVER BIG THE BANK. THE BLOCK CACHE AND THE JIT KEY THEIR CODE BY THE
+     * HOST PAGE, SO CODE FROM THE OLD BANK STAYS CACHED FOR WHEN IT COMES BACK.
+     *
+     * THE BANK REGISTERS LIVE IN THE STATE ARENA (state::Cart), SO A SNAPSHOT
+     * CARRIES THEM. cpu::CPU::loadState() CALLS restore(), WHICH MAPS WHAT THE
+     * ARENA SAYS, AND A NEW MAPPER STARTS FROM reset().
+     *
+     * Mapper ITSELF IS NROM: 16 OR 32 KB OF PRG AT $8000 (16 KB MIRRORED) AND
+     * WRITES IGNORED. create() GIVES IT FOR ANY MAPPER IT DOES NOT KNOW, WHICH
+     * RUNS THE FIRST AND LAST BANK LIKE BEFORE THERE WERE MAPPERS.
+     *
+     * CHR BANKS ARE TRACKED THE SAME WAY (getCHR()) FOR WHEN THE PPU FETCHES
+     * THROUGH THEM; IT ONLY DECODES THE FIRST 8 KB SO FAR (SEE PPU.h).
+     */
+
+    enum Mirroring{
+        HORIZONTAL  = 0,
+        VERTICAL    = 1,
+        SINGLE_LOW  = 2,        // ONE SCREEN, $2000
+        SINGLE_HIGH = 3,        // ONE SCREEN, $2400
+        FOUR_SCREEN = 4
+    };
+
+    class Mapper{
+
+        private:
+
+            // WHAT THE BUS SHOWS IN EACH 8 KB SLOT, SO A WRITE THAT SELECTS THE
+            // BANK ALREADY THERE DOES NOT REMAP. NULL UNTIL THE FIRST MAP.
+            const mos6502::i8 *mapped[4];
+
+            static void writeRegister(void *context, mos6502::i16 addr, mos6502::i8 data);
+
+            Mapper(const Mapper &);
+            Mapper &operator=(const Mapper &);
+
+        protected:
+
+            const rom::ROM *rom;
+            cpu::CPU *cpu;
+            state::Cart *cart;
+
+            const mos6502::i8 *prg;
+            uint32_t prgBanks;          // 8 KB
+            const mos6502::i8 *chr;
+            uint32_t chrBanks;          // 1 KB, 0 FOR CHR RAM
+
+            // SELECT BANKS, IN UNITS OF THE SLOT SIZE. A BANK PAST THE END WRAPS,
+            // AS THE UNCONNECTED HIGH ADDRESS LINES OF A SMALLER ROM DO.
+            void setPRG8(int slot, uint32_t bank);
+            void setPRG16(int slot, uint32_t bank);
+            void setPRG32(uint32_t bank);
+            void setCHR1(int slot, uint32_t bank);
+            void setCHR4(int slot, uint32_t bank);
+            void setCHR8(uint32_t bank);
+
+            // POWER-ON REGISTERS AND BANKS.
+            virtual void power();
+            // A CPU WRITE TO $8000-$FFFF.
+            virtual void write(mos6502::i16 addr, mos6502::i8 data);
+
+        public:
+
+            // TAKES OVER cpu's $8000-$FFFF AND ATTACHES TO IT (cpu::CPU::setMapper()).
+            // rom MUST OUTLIVE THE MAPPER, AND THE MAPPER THE CPU'S USE OF IT.
+            Mapper(const rom::ROM &rom, cpu::CPU &cpu);
+
+            // POWER ON: AFTER cpu::CPU::reset(), BEFORE readResetVector().
+            void reset();
+
+            // MAP THE BANKS state::Cart HOLDS, AFTER IT WAS LOADED FROM A SNAPSHOT.
+            void restore();
+
+            // A SCANLINE'S WORTH OF PPU A12 RISES, FOR THE MAPPERS THAT COUNT
+            // THEM (MMC3). NOTHING CALLS IT UNTIL THE PPU HAS TIMING.
+            virtual void scanline(){}
+
+            virtual const char *getName() const{return "NROM";}
+            mos6502::i8 getMirroring() const{return this->cart->mirroring;}
+            bool getIRQ() const{return this->cart->irq != 0;}
+
+            // THE 1 KB OF CHR ROM AT PPU $0000 + slot * $400, NULL WITH CHR RAM.
+            const mos6502::i8 *getCHR(int slot) const;
+
+            // GIVES $8000-$FFFF BACK TO THE BUS'S OWN PRG WINDOW.
+            virtual ~Mapper();
+    };
+
+    typedef Mapper *(*Factory)(const rom::ROM &rom, cpu::CPU &cpu);
+
+    // THE MAPPER FOR rom's MAPPER NUMBER, OR A PLAIN Mapper IF NONE IS
+    // REGISTERED. NEVER NULL; THE CALLER DELETES IT BEFORE THE CPU AND ROM.
+    Mapper *create(const rom::ROM &rom, cpu::CPU &cpu);
+
+    // BUILT IN: 0 NROM, 1 MMC1, 2 UxROM, 3 CNROM, 4 MMC3, 7 AxROM. add() PLUGS
+    // IN ANOTHER (OR REPLACES ONE) BEFORE THE NEXT create(); NOT THREAD SAFE
+    // AGAINST create() RUNNING ON OTHER THREADS.
+    void add(int number, Factory factory);
+    bool isSupported(int number);
+};
+
+#endif // !__MAPPER_H__
@@ -0,0 +1,149 @@
+#ifndef __MOVIE_H__
+#define __MOVIE_H__
+
+#include "MOS6502.h"
+#include "STATE.h"
+#include "CPU.h"
+#include "joypads.h"
+#include <vector>
+
+namespace movie{
+
+    /**
+     * INPUT MOVIES.
+     *
+     * A MOVIE IS THE CONTROLLER BITMASKS OF EVERY FRAME (ONE BYTE PER PORT),
+     * THE CRC-32 OF THE ROM IT WAS RECORDED ON, AND EVERY interval FRAMES A
+     * KEYFRAME: THE WHOLE STATE ARENA AT THE START OF THAT FRAME, SHRUNK WITH
+     * THE REWIND CODEC (SEE REWIND.h) AGAINST ZERO. KEYFRAME i IS ALWAYS AT
+     * FRAME i * interval, SO FINDING ONE IS A DIVISION.
+     *
+     * FRAME f IS PLAYED BY SETTING THE PADS TO THE INPUT OF f AND RUNNING ONE
+     * cpu::CPU::runFrame(). SEEKING TO f RESTORES KEYFRAME f / interval AND
+     * REPLAYS THE FRAMES AFTER IT, AT MOST interval - 1. REPLAY IS
+     * DETERMINISTIC, SO A KEYFRAME ALSO CHECKS A PLAYBACK: THE STATE REACHED
+     * AT ITS FRAME MUST BE BYTE FOR BYTE THE STORED ONE, INCLUDING WHERE THE
+     * FRAME ENDED. THE JIT ONLY RUNS A BLOCK THAT IS SURE TO FINISH IN THE
+     * FRAME, SO A MOVIE PLAYS BACK THE SAME ON EITHER TIER.
+     *
+     * ON DISK: Header, THE INPUTS (frames * ports BYTES), THE KEYFRAME INDEX,
+     * THEN THE ENCODED KEYFRAMES. HOST BYTE ORDER; KEYFRAMES ONLY LOAD INTO THE
+     * state::VERSION AND sizeof(state::Machine) THEY WERE RECORDED WITH.
+     */
+
+    static const uint32_t MAGIC    = 0x4D53454E;   // "NESM"
+    static const uint32_t VERSION  = 1;
+    static const uint32_t INTERVAL = 600;          // 10 S OF NTSC FRAMES
+
+    struct Header{
+        uint32_t magic;
+        uint32_t version;
+        uint32_t romCRC;            // rom::ROM::getCRC32() OF THE RECORDING
+        uint32_t frames;
+        uint32_t ports;             // INPUT BYTES PER FRAME, 1 OR 2
+        uint32_t interval;          // FRAMES BETWEEN KEYFRAMES
+        uint32_t keyframes;
+        uint32_t stateVersion;      // state::VERSION
+        uint32_t stateSize;         // sizeof(state::Machine)
+        uint32_t reserved;
+    };
+
+    struct Keyframe{
+        uint32_t frame;
+        uint32_t offset;            // INTO THE ENCODED KEYFRAMES
+        uint32_t length;
+    };
+
+    class Movie{
+
+        private:
+
+            Header header;
+            std::vector<mos6502::i8> inputs;
+            std::vector<Keyframe> index;
+            std::vector<mos6502::i8> blobs;
+            std::vector<mos6502::i8> zero;
+            std::vector<mos6502::i8> scratch;
+
+        public:
+
+            Movie();
+
+            // START AN EMPTY RECORDING.
+            void create(uint32_t romCRC, int ports = 1, uint32_t interval = INTERVAL);
+
+            // ADD FRAME getFrames(): input HOLDS ports BYTES, machine IS THE STATE
+            // BEFORE THE FRAME RUNS (STORED WHEN IT FALLS ON A KEYFRAME).
+            void append(const mos6502::i8 *input, const state::Machine &machine);
+
+            // DROP EVERY FRAME FROM frames ON, E.G. TO RE-RECORD FROM A SEEK.
+            void truncate(uint32_t frames);
+
+            // 0 ON SUCCESS, -1 IF THE FILE CANNOT BE WRITTEN/READ OR IS NOT A MOVIE.
+            int save(const char *path);
+            int load(const char *path);
+
+            uint32_t getFrames() const{return this->header.frames;}
+            uint32_t getPorts() const{return this->header.ports;}
+            uint32_t getInterval() const{return this->header.interval;}
+            uint32_t getRomCRC() const{return this->header.romCRC;}
+            size_t getKeyframes() const{return this->index.size();}
+
+            inline mos6502::i8 getInput(uint32_t frame, int port){
+                return port < (int)this->header.ports ? this->inputs[frame * this->header.ports + port] : 0;
+            }
+
+            inline bool isKeyframe(uint32_t frame){
+                return frame % this->header.interval == 0 && frame / this->header.interval < this->index.size();
+            }
+
+            // STATE AT THE START OF THE LAST KEYFRAME AT OR BEFORE frame, WRITTEN
+            // TO machine. RETURNS THAT KEYFRAME'S FRAME.
+            uint32_t restore(uint32_t frame, state::Machine &machine);
+
+            // DOES machine MATCH THE KEYFRAME AT frame (isKeyframe(frame) MUST HOLD)?
+            bool matches(uint32_t frame, const state::Machine &machine);
+
+            ~Movie();
+    };
+
+    // DRIVES A MACHINE THROUGH A MOVIE: PLAYBACK, SEEKING AND RECORDING.
+    class Player{
+
+        private:
+
+            Movie *movie;
+            cpu::CPU *cpu;
+            nes::JoyPads *pads;
+            uint32_t frame;                 // THE NEXT FRAME TO RUN
+
+            void run(uint32_t frame);
+
+        public:
+
+            Player(Movie &movie, cpu::CPU &cpu, nes::JoyPads &pads);
+
+            // RUN THE NEXT FRAME WITH ITS RECORDED INPUT. FALSE AT THE END.
+            bool step();
+
+            // PUT THE MACHINE AT THE START OF frame (CLAMPED TO THE MOVIE). RUNS
+            // FORWARD WHEN THAT IS SHORTER, ELSE RESTORES THE KEYFRAME. RETURNS
+            // THE FRAMES REPLAYED.
+            uint32_t seek(uint32_t frame);
+
+            // RUN THE NEXT FRAME WITH input (ports BYTES) AND RECORD IT, CUTTING
+            // OFF WHATEVER THE MOVIE HAD FROM HERE ON.
+            void record(const mos6502::i8 *input);
+
+            // PLAY FROM THE CURRENT FRAME TO THE END, COMPARING EVERY KEYFRAME
+            // REACHED. RETURNS THE MISMATCHES; checked COUNTS THE KEYFRAMES SEEN.
+            uint32_t verify(uint32_t &checked);
+
+            uint32_t getFrame() const{return this->frame;}
+
+            ~Player();
+    };
+
+};
+
+#endif // !__MOVIE_H__
@@ -1,32 +1,108 @@
 #ifndef __NES_H__
 #define __NES_H__
 
+#include "MOS6502.h"
+#include "ROM.h"
 #include "CPU.h"
+#include "PPU.h"
+#include "MAPPER.h"
+#include "BATTERY.h"
+#include "APU.h"
+#include "joypads.h"
 
 namespace nes
 {
-       class NES
-       {
-       private:
-              cpu::CPU *cpu;
-       public:
-              NES();
-
-              mos6502::i8 loadProgram();
-              mos6502::i8 run();
-              mos6502::i8 reset();
-
-              ~NES();
-       };
-       
-       NES::NES()
-       {
-       }
-       
-       NES::~NES()
-       {
-       }
-       
+    /**
+     * THE WHOLE MACHINE, WITHOUT A WINDOW.
+     *
+     * OWNS THE CARTRIDGE, CPU, PPU, APU AND CONTROLLERS AND WIRES THEM UP THE
+     * WAY App USED TO. NOTHING HERE TOUCHES SDL, SO THE CORE (make lib) RUNS ON
+     * A SERVER WITH NO DISPLAY; App IS ONE FRONT END OVER IT.
+     *
+     *     nes::NES nes;
+     *     nes.loadRom("game_rom/donkykong.nes");
+     *     nes.setInput(0, nes::JoyPads::START);
+     *     nes.stepFrame();
+     *     const mos6502::i8 *pixels = nes.framebuffer();
+     *
+     * A FRAME IS ONE cpu::CPU::runFrame() WITH THE INPUT HELD, THE SAME FRAME
+     * THE BATCH RUNNER AND MOVIES USE, SO A MOVIE PLAYS BACK IDENTICALLY HERE.
+     * IT OPENS WITH VBLANK: PPUSTATUS BIT 7 UP AND, IF PPUCTRL ASKS FOR IT, AN
+     * NMI. THE PPU ONLY DECODES THE PATTERN TABLES SO FAR (SEE PPU.h), SO THAT
+     * IS ALL OF IT THE GAME SEES.
+     *
+     * THE CPU, AND SO THE STATE ARENA, LIVES AS LONG AS THE NES: LOADING
+     * ANOTHER CARTRIDGE RESETS IT IN PLACE, SO POINTERS INTO RAM AND THE
+     * FRAMEBUFFER STAY VALID UNTIL THE NES IS DESTROYED.
+     */
+    class NES
+    {
+        private:
+
+            rom::ROM *rom;
+            mapper::Mapper *mapper;
+            battery::Save *save;
+            cpu::CPU *cpu;
+            ppu::PPU *ppu;
+            APU *apu;
+            JoyPads *pads;
+
+            int insert(rom::ROM *rom);
+
+        public:
+
+            static const int WIDTH  = ppu::WIDTH;
+            static const int HEIGHT = ppu::HEIGHT;
+
+            NES();
+
+            // LOAD AN iNES FILE, OR AN iNES IMAGE OF size BYTES (COPIED), AND
+            // POWER ON. 0 ON SUCCESS, -1 IF IT CANNOT BE READ OR HAS NO PRG ROM,
+            // WHICH LEAVES NO CARTRIDGE IN.
+            int loadRom(const char *path);
+            int loadRom(const mos6502::i8 *data, size_t size);
+            bool isLoaded() const{return this->rom != NULL;}
+
+            // POWER CYCLE THE LOADED CARTRIDGE, BACK TO EXACTLY THE STATE loadRom()
+            // LEFT, BATTERY RAM ASIDE. -1 WITHOUT ONE.
+            int reset();
+
+            // KEEP THE CARTRIDGE'S BATTERY RAM IN path (SEE BATTERY.h), UNTIL
+            // ANOTHER ONE IS LOADED. CALL IT RIGHT AFTER loadRom(), BEFORE THE GAME
+            // LOOKS AT $6000. -1 WITHOUT A CARTRIDGE, WITHOUT A BATTERY, OR IF
+            // path CANNOT BE MAPPED. NOTHING IS SAVED UNLESS THIS IS CALLED.
+            int openSave(const char *path, uint32_t interval = battery::INTERVAL);
+            battery::Save *getSave(){return this->save;}
+
+            // BUTTONS HELD ON port (0 OR 1), A BITMASK OF JoyPads::Button.
+            void setInput(int port, mos6502::i8 mask);
+
+            // RUN ONE FRAME. RETURNS THE CPU CYCLES IT TOOK, 0 WITHOUT A CARTRIDGE.
+            uint32_t stepFrame();
+
+            // WIDTH * HEIGHT NES COLOUR INDICES (0-63, SEE ppu::PALETTE), ROW MAJOR.
+            const mos6502::i8 *framebuffer();
+
+            // THE 2 KB WORK RAM, IN PLACE. READ ONLY: A WRITE STRAIGHT INTO IT
+            // WOULD MISS THE CODE WATCH, AND BLOCKS DECODED FROM RAM WOULD GO ON
+            // RUNNING THE OLD BYTES. WRITE THROUGH poke().
+            const mos6502::i8 *ram(){return this->cpu->getBus().getRAM();}
+
+            // STORE data AT CPU ADDRESS addr THROUGH THE BUS, AS THE GAME WOULD:
+            // CACHED CODE ON THE PAGE IS DROPPED.
+            void poke(mos6502::i16 addr, mos6502::i8 data){this->cpu->write(addr, data);}
+
+            // FOR FRONT ENDS THAT NEED MORE (SAVESTATES, REWIND, TILE VIEWERS).
+            // getROM() AND getMapper() ARE NULL WITHOUT A CARTRIDGE.
+            rom::ROM *getROM(){return this->rom;}
+            mapper::Mapper *getMapper(){return this->mapper;}
+            cpu::CPU *getCPU(){return this->cpu;}
+            ppu::PPU *getPPU(){return this->ppu;}
+            JoyPads *getPads(){return this->pads;}
+
+            ~NES();
+    };
+
 }; // nes
 
-#endif //!__NES_H__
\ No newline at end of file
+#endif //!__NES_H__
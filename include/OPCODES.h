@@ -0,0 +1,275 @@
+#ifndef __OPCODES_H__
+#define __OPCODES_H__
+
+/**
+ * MOS 6502 OPCODE MATRIX, ONE ROW PER OPCODE IN OPCODE ORDER (0X00 - 0XFF).
+ *
+ *     X(OP, NAME, ADDRESSING MODE, BYTES, BASE CYCLES, PAGE CROSS PENALTY)
+ *
+ * NAME IS THE CPU MEMBER HANDLER, ADDRESSING MODE IS A CPU::AddressingMode.
+ * PAGE CROSS PENALTY IS 1 FOR INSTRUCTIONS THAT TAKE ONE MORE CYCLE WHEN THE
+ * EFFECTIVE ADDRESS (OR BRANCH TARGET) CROSSES A PAGE BOUNDARY.
+ *
+ * EXPAND IT WITH A MACRO TAKING THOSE SIX ARGUMENTS, E.G. TO BUILD THE DENSE
+ * DISPATCH TABLE IN CPU.cpp. ROWS MUST STAY IN OPCODE ORDER.
+ */
+#define MOS6502_OPCODES(X) \
+    X(0x00, BRK, IMPLICIT        , 1, 7, 0) \
+    X(0x01, ORA, INDEXED_INDIRECT, 2, 6, 0) \
+    X(0x02, KIL, IMPLICIT        , 1, 2, 0) \
+    X(0x03, SLO, INDEXED_INDIRECT, 2, 8, 0) \
+    X(0x04, NOP, ZEROPAGE        , 2, 3, 0) \
+    X(0x05, ORA, ZEROPAGE        , 2, 3, 0) \
+    X(0x06, ASL, ZEROPAGE        , 2, 5, 0) \
+    X(0x07, SLO, ZEROPAGE        , 2, 5, 0) \
+    X(0x08, PHP, IMPLICIT        , 1, 3, 0) \
+    X(0x09, ORA, IMMEDIATE       , 2, 2, 0) \
+    X(0x0A, ASL, ACCEUMULATOR    , 1, 2, 0) \
+    X(0x0B, ANC, IMMEDIATE       , 2, 2, 0) \
+    X(0x0C, NOP, ABSOLUTE        , 3, 4, 0) \
+    X(0x0D, ORA, ABSOLUTE        , 3, 4, 0) \
+    X(0x0E, ASL, ABSOLUTE        , 3, 6, 0) \
+    X(0x0F, SLO, ABSOLUTE        , 3, 6, 0) \
+    X(0x10, BPL, RELATIVE        , 2, 2, 1) \
+    X(0x11, ORA, INDIRECT_INDEXED, 2, 5, 1) \
+    X(0x12, KIL, IMPLICIT        , 1, 2, 0) \
+    X(0x13, SLO, INDIRECT_INDEXED, 2, 8, 0) \
+    X(0x14, NOP, ZEROPAGEX       , 2, 4, 0) \
+    X(0x15, ORA, ZEROPAGEX       , 2, 4, 0) \
+    X(0x16, ASL, ZEROPAGEX       , 2, 6, 0) \
+    X(0x17, SLO, ZEROPAGEX       , 2, 6, 0) \
+    X(0x18, CLC, IMPLICIT        , 1, 2, 0) \
+    X(0x19, ORA, ABSOLUTEY       , 3, 4, 1) \
+    X(0x1A, NOP, IMPLICIT        , 1, 2, 0) \
+    X(0x1B, SLO, ABSOLUTEY       , 3, 7, 0) \
+    X(0x1C, NOP, ABSOLUTEX       , 3, 4, 1) \
+    X(0x1D, ORA, ABSOLUTEX       , 3, 4, 1) \
+    X(0x1E, ASL, ABSOLUTEX       , 3, 7, 0) \
+    X(0x1F, SLO, ABSOLUTEX       , 3, 7, 0) \
+    X(0x20, JSR, ABSOLUTE        , 3, 6, 0) \
+    X(0x21, AND, INDEXED_INDIRECT, 2, 6, 0) \
+    X(0x22, KIL, IMPLICIT        , 1, 2, 0) \
+    X(0x23, RLA, INDEXED_INDIRECT, 2, 8, 0) \
+    X(0x24, BIT, ZEROPAGE        , 2, 3, 0) \
+    X(0x25, AND, ZEROPAGE        , 2, 3, 0) \
+    X(0x26, ROL, ZEROPAGE        , 2, 5, 0) \
+    X(0x27, RLA, ZEROPAGE        , 2, 5, 0) \
+    X(0x28, PLP, IMPLICIT        , 1, 4, 0) \
+    X(0x29, AND, IMMEDIATE       , 2, 2, 0) \
+    X(0x2A, ROL, ACCEUMULATOR    , 1, 2, 0) \
+    X(0x2B, ANC, IMMEDIATE       , 2, 2, 0) \
+    X(0x2C, BIT, ABSOLUTE        , 3, 4, 0) \
+    X(0x2D, AND, ABSOLUTE        , 3, 4, 0) \
+    X(0x2E, ROL, ABSOLUTE        , 3, 6, 0) \
+    X(0x2F, RLA, ABSOLUTE        , 3, 6, 0) \
+    X(0x30, BMI, RELATIVE        , 2, 2, 1) \
+    X(0x31, AND, INDIRECT_INDEXED, 2, 5, 1) \
+    X(0x32, KIL, IMPLICIT        , 1, 2, 0) \
+    X(0x33, RLA, INDIRECT_INDEXED, 2, 8, 0) \
+    X(0x34, NOP, ZEROPAGEX       , 2, 4, 0) \
+    X(0x35, AND, ZEROPAGEX       , 2, 4, 0) \
+    X(0x36, ROL, ZEROPAGEX       , 2, 6, 0) \
+    X(0x37, RLA, ZEROPAGEX       , 2, 6, 0) \
+    X(0x38, SEC, IMPLICIT        , 1, 2, 0) \
+    X(0x39, AND, ABSOLUTEY       , 3, 4, 1) \
+    X(0x3A, NOP, IMPLICIT        , 1, 2, 0) \
+    X(0x3B, RLA, ABSOLUTEY       , 3, 7, 0) \
+    X(0x3C, NOP, ABSOLUTEX       , 3, 4, 1) \
+    X(0x3D, AND, ABSOLUTEX       , 3, 4, 1) \
+    X(0x3E, ROL, ABSOLUTEX       , 3, 7, 0) \
+    X(0x3F, RLA, ABSOLUTEX       , 3, 7, 0) \
+    X(0x40, RTI, IMPLICIT        , 1, 6, 0) \
+    X(0x41, EOR, INDEXED_INDIRECT, 2, 6, 0) \
+    X(0x42, KIL, IMPLICIT        , 1, 2, 0) \
+    X(0x43, SRE, INDEXED_INDIRECT, 2, 8, 0) \
+    X(0x44, NOP, ZEROPAGE        , 2, 3, 0) \
+    X(0x45, EOR, ZEROPAGE        , 2, 3, 0) \
+    X(0x46, LSR, ZEROPAGE        , 2, 5, 0) \
+    X(0x47, SRE, ZEROPAGE        , 2, 5, 0) \
+    X(0x48, PHA, IMPLICIT        , 1, 3, 0) \
+    X(0x49, EOR, IMMEDIATE       , 2, 2, 0) \
+    X(0x4A, LSR, ACCEUMULATOR    , 1, 2, 0) \
+    X(0x4B, ALR, IMMEDIATE       , 2, 2, 0) \
+    X(0x4C, JMP, ABSOLUTE        , 3, 3, 0) \
+    X(0x4D, EOR, ABSOLUTE        , 3, 4, 0) \
+    X(0x4E, LSR, ABSOLUTE        , 3, 6, 0) \
+    X(0x4F, SRE, ABSOLUTE        , 3, 6, 0) \
+    X(0x50, BVC, RELATIVE        , 2, 2, 1) \
+    X(0x51, EOR, INDIRECT_INDEXED, 2, 5, 1) \
+    X(0x52, KIL, IMPLICIT        , 1, 2, 0) \
+    X(0x53, SRE, INDIRECT_INDEXED, 2, 8, 0) \
+    X(0x54, NOP, ZEROPAGEX       , 2, 4, 0) \
+    X(0x55, EOR, ZEROPAGEX       , 2, 4, 0) \
+    X(0x56, LSR, ZEROPAGEX       , 2, 6, 0) \
+    X(0x57, SRE, ZEROPAGEX       , 2, 6, 0) \
+    X(0x58, CLI, IMPLICIT        , 1, 2, 0) \
+    X(0x59, EOR, ABSOLUTEY       , 3, 4, 1) \
+    X(0x5A, NOP, IMPLICIT        , 1, 2, 0) \
+    X(0x5B, SRE, ABSOLUTEY       , 3, 7, 0) \
+    X(0x5C, NOP, ABSOLUTEX       , 3, 4, 1) \
+    X(0x5D, EOR, ABSOLUTEX       , 3, 4, 1) \
+    X(0x5E, LSR, ABSOLUTEX       , 3, 7, 0) \
+    X(0x5F, SRE, ABSOLUTEX       , 3, 7, 0) \
+    X(0x60, RTS, IMPLICIT        , 1, 6, 0) \
+    X(0x61, ADC, INDEXED_INDIRECT, 2, 6, 0) \
+    X(0x62, KIL, IMPLICIT        , 1, 2, 0) \
+    X(0x63, RRA, INDEXED_INDIRECT, 2, 8, 0) \
+    X(0x64, NOP, ZEROPAGE        , 2, 3, 0) \
+    X(0x65, ADC, ZEROPAGE        , 2, 3, 0) \
+    X(0x66, ROR, ZEROPAGE        , 2, 5, 0) \
+    X(0x67, RRA, ZEROPAGE        , 2, 5, 0) \
+    X(0x68, PLA, IMPLICIT        , 1, 4, 0) \
+    X(0x69, ADC, IMMEDIATE       , 2, 2, 0) \
+    X(0x6A, ROR, ACCEUMULATOR    , 1, 2, 0) \
+    X(0x6B, ARR, IMMEDIATE       , 2, 2, 0) \
+    X(0x6C, JMP, INDIRECT        , 3, 5, 0) \
+    X(0x6D, ADC, ABSOLUTE        , 3, 4, 0) \
+    X(0x6E, ROR, ABSOLUTE        , 3, 6, 0) \
+    X(0x6F, RRA, ABSOLUTE        , 3, 6, 0) \
+    X(0x70, BVS, RELATIVE        , 2, 2, 1) \
+    X(0x71, ADC, INDIRECT_INDEXED, 2, 5, 1) \
+    X(0x72, KIL, IMPLICIT        , 1, 2, 0) \
+    X(0x73, RRA, INDIRECT_INDEXED, 2, 8, 0) \
+    X(0x74, NOP, ZEROPAGEX       , 2, 4, 0) \
+    X(0x75, ADC, ZEROPAGEX       , 2, 4, 0) \
+    X(0x76, ROR, ZEROPAGEX       , 2, 6, 0) \
+    X(0x77, RRA, ZEROPAGEX       , 2, 6, 0) \
+    X(0x78, SEI, IMPLICIT        , 1, 2, 0) \
+    X(0x79, ADC, ABSOLUTEY       , 3, 4, 1) \
+    X(0x7A, NOP, IMPLICIT        , 1, 2, 0) \
+    X(0x7B, RRA, ABSOLUTEY       , 3, 7, 0) \
+    X(0x7C, NOP, ABSOLUTEX       , 3, 4, 1) \
+    X(0x7D, ADC, ABSOLUTEX       , 3, 4, 1) \
+    X(0x7E, ROR, ABSOLUTEX       , 3, 7, 0) \
+    X(0x7F, RRA, ABSOLUTEX       , 3, 7, 0) \
+    X(0x80, NOP, IMMEDIATE       , 2, 2, 0) \
+    X(0x81, STA, INDEXED_INDIRECT, 2, 6, 0) \
+    X(0x82, NOP, IMMEDIATE       , 2, 2, 0) \
+    X(0x83, SAX, INDEXED_INDIRECT, 2, 6, 0) \
+    X(0x84, STY, ZEROPAGE        , 2, 3, 0) \
+    X(0x85, STA, ZEROPAGE        , 2, 3, 0) \
+    X(0x86, STX, ZEROPAGE        , 2, 3, 0) \
+    X(0x87, SAX, ZEROPAGE        , 2, 3, 0) \
+    X(0x88, DEY, IMPLICIT        , 1, 2, 0) \
+    X(0x89, NOP, IMMEDIATE       , 2, 2, 0) \
+    X(0x8A, TXA, IMPLICIT        , 1, 2, 0) \
+    X(0x8B, XAA, IMMEDIATE       , 2, 2, 0) \
+    X(0x8C, STY, ABSOLUTE        , 3, 4, 0) \
+    X(0x8D, STA, ABSOLUTE        , 3, 4, 0) \
+    X(0x8E, STX, ABSOLUTE        , 3, 4, 0) \
+    X(0x8F, SAX, ABSOLUTE        , 3, 4, 0) \
+    X(0x90, BCC, RELATIVE        , 2, 2, 1) \
+    X(0x91, STA, INDIRECT_INDEXED, 2, 6, 0) \
+    X(0x92, KIL, IMPLICIT        , 1, 2, 0) \
+    X(0x93, AHX, INDIRECT_INDEXED, 2, 6, 0) \
+    X(0x94, STY, ZEROPAGEX       , 2, 4, 0) \
+    X(0x95, STA, ZEROPAGEX       , 2, 4, 0) \
+    X(0x96, STX, ZEROPAGEY       , 2, 4, 0) \
+    X(0x97, SAX, ZEROPAGEY       , 2, 4, 0) \
+    X(0x98, TYA, IMPLICIT        , 1, 2, 0) \
+    X(0x99, STA, ABSOLUTEY       , 3, 5, 0) \
+    X(0x9A, TXS, IMPLICIT        , 1, 2, 0) \
+    X(0x9B, TAS, ABSOLUTEY       , 3, 5, 0) \
+    X(0x9C, SHY, ABSOLUTEX       , 3, 5, 0) \
+    X(0x9D, STA, ABSOLUTEX       , 3, 5, 0) \
+    X(0x9E, SHX, ABSOLUTEY       , 3, 5, 0) \
+    X(0x9F, AHX, ABSOLUTEY       , 3, 5, 0) \
+    X(0xA0, LDY, IMMEDIATE       , 2, 2, 0) \
+    X(0xA1, LDA, INDEXED_INDIRECT, 2, 6, 0) \
+    X(0xA2, LDX, IMMEDIATE       , 2, 2, 0) \
+    X(0xA3, LAX, INDEXED_INDIRECT, 2, 6, 0) \
+    X(0xA4, LDY, ZEROPAGE        , 2, 3, 0) \
+    X(0xA5, LDA, ZEROPAGE        , 2, 3, 0) \
+    X(0xA6, LDX, ZEROPAGE        , 2, 3, 0) \
+    X(0xA7, LAX, ZEROPAGE        , 2, 3, 0) \
+    X(0xA8, TAY, IMPLICIT        , 1, 2, 0) \
+    X(0xA9, LDA, IMMEDIATE       , 2, 2, 0) \
+    X(0xAA, TAX, IMPLICIT        , 1, 2, 0) \
+    X(0xAB, LAX, IMMEDIATE       , 2, 2, 0) \
+    X(0xAC, LDY, ABSOLUTE        , 3, 4, 0) \
+    X(0xAD, LDA, ABSOLUTE        , 3, 4, 0) \
+    X(0xAE, LDX, ABSOLUTE        , 3, 4, 0) \
+    X(0xAF, LAX, ABSOLUTE        , 3, 4, 0) \
+    X(0xB0, BCS, RELATIVE        , 2, 2, 1) \
+    X(0xB1, LDA, INDIRECT_INDEXED, 2, 5, 1) \
+    X(0xB2, KIL, IMPLICIT        , 1, 2, 0) \
+    X(0xB3, LAX, INDIRECT_INDEXED, 2, 5, 1) \
+    X(0xB4, LDY, ZEROPAGEX       , 2, 4, 0) \
+    X(0xB5, LDA, ZEROPAGEX       , 2, 4, 0) \
+    X(0xB6, LDX, ZEROPAGEY       , 2, 4, 0) \
+    X(0xB7, LAX, ZEROPAGEY       , 2, 4, 0) \
+    X(0xB8, CLV, IMPLICIT        , 1, 2, 0) \
+    X(0xB9, LDA, ABSOLUTEY       , 3, 4, 1) \
+    X(0xBA, TSX, IMPLICIT        , 1, 2, 0) \
+    X(0xBB, LAS, ABSOLUTEY       , 3, 4, 1) \
+    X(0xBC, LDY, ABSOLUTEX       , 3, 4, 1) \
+    X(0xBD, LDA, ABSOLUTEX       , 3, 4, 1) \
+    X(0xBE, LDX, ABSOLUTEY       , 3, 4, 1) \
+    X(0xBF, LAX, ABSOLUTEY       , 3, 4, 1) \
+    X(0xC0, CPY, IMMEDIATE       , 2, 2, 0) \
+    X(0xC1, CMP, INDEXED_INDIRECT, 2, 6, 0) \
+    X(0xC2, NOP, IMMEDIATE       , 2, 2, 0) \
+    X(0xC3, DCP, INDEXED_INDIRECT, 2, 8, 0) \
+    X(0xC4, CPY, ZEROPAGE        , 2, 3, 0) \
+    X(0xC5, CMP, ZEROPAGE        , 2, 3, 0) \
+    X(0xC6, DEC, ZEROPAGE        , 2, 5, 0) \
+    X(0xC7, DCP, ZEROPAGE        , 2, 5, 0) \
+    X(0xC8, INY, IMPLICIT        , 1, 2, 0) \
+    X(0xC9, CMP, IMMEDIATE       , 2, 2, 0) \
+    X(0xCA, DEX, IMPLICIT        , 1, 2, 0) \
+    X(0xCB, AXS, IMMEDIATE       , 2, 2, 0) \
+    X(0xCC, CPY, ABSOLUTE        , 3, 4, 0) \
+    X(0xCD, CMP, ABSOLUTE        , 3, 4, 0) \
+    X(0xCE, DEC, ABSOLUTE        , 3, 6, 0) \
+    X(0xCF, DCP, ABSOLUTE        , 3, 6, 0) \
+    X(0xD0, BNE, RELATIVE        , 2, 2, 1) \
+    X(0xD1, CMP, INDIRECT_INDEXED, 2, 5, 1) \
+    X(0xD2, KIL, IMPLICIT        , 1, 2, 0) \
+    X(0xD3, DCP, INDIRECT_INDEXED, 2, 8, 0) \
+    X(0xD4, NOP, ZEROPAGEX       , 2, 4, 0) \
+    X(0xD5, CMP, ZEROPAGEX       , 2, 4, 0) \
+    X(0xD6, DEC, ZEROPAGEX       , 2, 6, 0) \
+    X(0xD7, DCP, ZEROPAGEX       , 2, 6, 0) \
+    X(0xD8, CLD, IMPLICIT        , 1, 2, 0) \
+    X(0xD9, CMP, ABSOLUTEY       , 3, 4, 1) \
+    X(0xDA, NOP, IMPLICIT        , 1, 2, 0) \
+    X(0xDB, DCP, ABSOLUTEY       , 3, 7, 0) \
+    X(0xDC, NOP, ABSOLUTEX       , 3, 4, 1) \
+    X(0xDD, CMP, ABSOLUTEX       , 3, 4, 1) \
+    X(0xDE, DEC, ABSOLUTEX       , 3, 7, 0) \
+    X(0xDF, DCP, ABSOLUTEX       , 3, 7, 0) \
+    X(0xE0, CPX, IMMEDIATE       , 2, 2, 0) \
+    X(0xE1, SBC, INDEXED_INDIRECT, 2, 6, 0) \
+    X(0xE2, NOP, IMMEDIATE       , 2, 2, 0) \
+    X(0xE3, ISC, INDEXED_INDIRECT, 2, 8, 0) \
+    X(0xE4, CPX, ZEROPAGE        , 2, 3, 0) \
+    X(0xE5, SBC, ZEROPAGE        , 2, 3, 0) \
+    X(0xE6, INC, ZEROPAGE        , 2, 5, 0) \
+    X(0xE7, ISC, ZEROPAGE        , 2, 5, 0) \
+    X(0xE8, INX, IMPLICIT        , 1, 2, 0) \
+    X(0xE9, SBC, IMMEDIATE       , 2, 2, 0) \
+    X(0xEA, NOP, IMPLICIT        , 1, 2, 0) \
+    X(0xEB, SBC, IMMEDIATE       , 2, 2, 0) \
+    X(0xEC, CPX, ABSOLUTE        , 3, 4, 0) \
+    X(0xED, SBC, ABSOLUTE        , 3, 4, 0) \
+    X(0xEE, INC, ABSOLUTE        , 3, 6, 0) \
+    X(0xEF, ISC, ABSOLUTE        , 3, 6, 0) \
+    X(0xF0, BEQ, RELATIVE        , 2, 2, 1) \
+    X(0xF1, SBC, INDIRECT_INDEXED, 2, 5, 1) \
+    X(0xF2, KIL, IMPLICIT        , 1, 2, 0) \
+    X(0xF3, ISC, INDIRECT_INDEXED, 2, 8, 0) \
+    X(0xF4, NOP, ZEROPAGEX       , 2, 4, 0) \
+    X(0xF5, SBC, ZEROPAGEX       , 2, 4, 0) \
+    X(0xF6, INC, ZEROPAGEX       , 2, 6, 0) \
+    X(0xF7, ISC, ZEROPAGEX       , 2, 6, 0) \
+    X(0xF8, SED, IMPLICIT        , 1, 2, 0) \
+    X(0xF9, SBC, ABSOLUTEY       , 3, 4, 1) \
+    X(0xFA, NOP, IMPLICIT        , 1, 2, 0) \
+    X(0xFB, ISC, ABSOLUTEY       , 3, 7, 0) \
+    X(0xFC, NOP, ABSOLUTEX       , 3, 4, 1) \
+    X(0xFD, SBC, ABSOLUTEX       , 3, 4, 1) \
+    X(0xFE, INC, ABSOLUTEX       , 3, 7, 0) \
+    X(0xFF, ISC, ABSOLUTEX       , 3, 7, 0)
+
+
+#endif // !__OPCODES_H__
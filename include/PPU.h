@@ -7,6 +7,13 @@
 
 
 namespace ppu{
+
+    // VISIBLE PICTURE, IN PIXELS.
+    static const int WIDTH  = 256;
+    static const int HEIGHT = 240;
+
+    // 0xRRGGBB OF THE 64 COLOURS A 2C02 CAN OUTPUT. FRAMES HOLD INDICES INTO IT.
+    extern const uint32_t PALETTE[64];
     
     typedef struct Tile{
         mos6502::i8 data[8][8];
@@ -24,14 +31,27 @@ namespace ppu{
 
 
             // buffers
-            
+            // THE PICTURE, WIDTH * HEIGHT COLOUR INDICES. UNTIL THE BACKGROUND AND
+            // SPRITE PIPELINES EXIST IT SHOWS THE TWO PATTERN TABLES SIDE BY SIDE.
+            mos6502::i8 frame[WIDTH * HEIGHT];
+            uint32_t version;               // BUMPED WHENEVER frame CHANGES
 
         public:
 
             PPU();
+
+            // BLANK PICTURE.
+            void reset();
             
             void step();
 
+            // DECODE AN 8 KB CHR BANK (512 TILES) INTO THE PICTURE.
+            void loadCHR(const mos6502::i8 *chr, size_t size);
+
+            const mos6502::i8 *getFrame() const{return this->frame;}
+            // LETS A CONSUMER SKIP COPYING A PICTURE IT ALREADY HAS.
+            uint32_t getVersion() const{return this->version;}
+
             mos6502::i8 *addTileInt8(mos6502::i8 first,mos6502::i8 second, mos6502::i8 *result); 
 
 
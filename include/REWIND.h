@@ -0,0 +1,101 @@
+#ifndef __REWIND_H__
+#define __REWIND_H__
+
+#include "MOS6502.h"
+#include "STATE.h"
+#include <vector>
+#include <deque>
+#include <stddef.h>
+
+namespace history{
+
+    /**
+     * REWIND BUFFER.
+     *
+     * ONE SNAPSHOT PER FRAME, KEPT IN A RING OF capacity BYTES. EVERY interval
+     * FRAMES THE SNAPSHOT IS A KEYFRAME; THE OTHERS ARE STORED AS THE XOR OF
+     * THE MACHINE AGAINST THAT KEYFRAME. A FRAME CHANGES A FEW HUNDRED BYTES OF
+     * THE 10 KB ARENA, SO THE XOR IS MOSTLY ZERO AND THE CODEC BELOW SHRINKS IT
+     * TO ROUGHLY WHAT CHANGED. KEYFRAMES GO THROUGH THE SAME CODEC AGAINST ZERO,
+     * WHICH STILL SQUEEZES THE CLEARED RAM AND SRAM.
+     *
+     * GOING BACK ANY NUMBER OF FRAMES IS ONE KEYFRAME DECODE PLUS AT MOST ONE
+     * DELTA, NEVER A REPLAY. WHEN THE RING IS FULL THE OLDEST KEYFRAME IS
+     * DROPPED TOGETHER WITH ITS DELTAS.
+     *
+     * CODEC: A SEQUENCE OF (u16 SKIP, u16 LENGTH, LENGTH BYTES) TOKENS. SKIP
+     * BYTES ARE EQUAL TO THE REFERENCE, THE LENGTH BYTES THAT FOLLOW ARE XORED
+     * ONTO IT. A LITERAL RUN ONLY ENDS AT 8 EQUAL BYTES, SO SHORT GAPS DO NOT
+     * COST A TOKEN EACH. EQUAL RUNS ARE FOUND 8 BYTES AT A TIME.
+     */
+
+    struct Stats{
+        uint64_t frames;            // SNAPSHOTS PUSHED
+        uint64_t keyframes;
+        uint64_t raw;               // BYTES BEFORE ENCODING
+        uint64_t encoded;           // BYTES AFTER
+        uint64_t dropped;           // SNAPSHOTS EVICTED TO STAY UNDER capacity
+    };
+
+    // XOR-ENCODE data AGAINST ref (size BYTES) INTO out, WHICH MUST HOLD
+    // maxEncoded(size). RETURNS THE ENCODED LENGTH.
+    size_t encode(const mos6502::i8 *data, const mos6502::i8 *ref, size_t size, mos6502::i8 *out);
+    // XOR THE ENCODED in (length BYTES) BACK ONTO data (size BYTES). FALSE,
+    // HAVING APPLIED ONLY THE TOKENS BEFORE IT, AT A TOKEN THAT RUNS PAST THE
+    // END OF in OR OF data, SO A CORRUPT BLOB NEVER WRITES OUTSIDE data.
+    bool apply(const mos6502::i8 *in, size_t length, mos6502::i8 *data, size_t size);
+    inline size_t maxEncoded(size_t size){return size + size / 2 + 16;}
+
+    class Buffer{
+
+        private:
+
+            struct Entry{
+                size_t offset;      // INTO ring
+                size_t length;
+                bool   keyframe;
+            };
+
+            std::vector<mos6502::i8> ring;
+            std::deque<Entry> entries;          // OLDEST FIRST, THE BACK IS THE LATEST FRAME
+            size_t head;                        // WHERE THE NEXT ENTRY GOES
+            size_t used;                        // BYTES HELD BY entries
+            int interval;
+            int sinceKey;                       // FRAMES PUSHED SINCE THE LAST KEYFRAME
+
+            // THE LATEST KEYFRAME, DECODED, WHICH NEW DELTAS ARE TAKEN AGAINST.
+            std::vector<mos6502::i8> key;
+            std::vector<mos6502::i8> scratch;
+
+            Stats stats;
+
+            void dropOldest();
+            size_t reserve(size_t length);
+
+        public:
+
+            // capacity BYTES OF HISTORY, A KEYFRAME EVERY interval FRAMES.
+            Buffer(size_t capacity, int interval = 60);
+
+            // RECORD THE STATE OF THE FRAME JUST RUN.
+            void push(const state::Machine &machine);
+
+            // STEP BACK frames FRAMES FROM THE LATEST ONE, WRITE THAT STATE TO
+            // machine AND FORGET EVERYTHING AFTER IT, SO THE NEXT push() CONTINUES
+            // FROM THERE. RETURNS THE FRAMES ACTUALLY STEPPED BACK, CLAMPED TO
+            // THE HISTORY HELD; 0 LEAVES machine ALONE.
+            int rewind(int frames, state::Machine &machine);
+
+            void clear();
+
+            size_t getFrames() const{return this->entries.size();}
+            size_t getCapacity() const{return this->ring.size();}
+            size_t getUsed() const{return this->used;}
+            const Stats &getStats() const{return this->stats;}
+
+            ~Buffer();
+    };
+
+};
+
+#endif // !__REWIND_H__
@@ -5,10 +5,39 @@
 #include "MOS6502.h"
 #include <vector>
 #include <string>
+#include <memory>
+#include <stddef.h>
 
 namespace rom{
 
+    // CRC-32 (IEEE 802.3, AS IN ZIP AND THE ROM DATABASES) OF size BYTES,
+    // CONTINUING FROM crc SO A ROM CAN BE HASHED BANK BY BANK.
+    uint32_t crc32(const mos6502::i8 *data, size_t size, uint32_t crc = 0);
 
+    // SHA-1 OF size BYTES INTO digest, FOR ROM SETS THAT KEY ON IT.
+    void sha1(const mos6502::i8 *data, size_t size, mos6502::i8 digest[20]);
+
+    // TV SYSTEM A DUMP DECLARES.
+    enum TVSystem{
+        NTSC = 0,
+        PAL  = 1,
+        DUAL = 2,       // RUNS ON BOTH
+    };
+
+    // NON-OWNING VIEW OF BYTES A ROM HOLDS, VALID UNTIL THE ROM IS RELOADED
+    // OR DESTROYED. COPYING ONE COPIES TWO WORDS, NOT THE BANK.
+    struct Span{
+        const mos6502::i8 *data;
+        size_t size;
+
+        Span() : data(NULL), size(0){}
+        Span(const mos6502::i8 *data, size_t size) : data(data), size(size){}
+
+        const mos6502::i8 &operator[](size_t i) const{return this->data[i];}
+        const mos6502::i8 *begin() const{return this->data;}
+        const mos6502::i8 *end() const{return this->data + this->size;}
+        bool empty() const{return this->size == 0;}
+    };
 
     class ROM{
 
@@ -76,27 +105,96 @@ namespace rom{
                 mos6502::i8 ff;
     
 
+            // THE WHOLE iNES IMAGE: THE FILE MAPPED READ ONLY BY loadNesFile() (OR
+            // A STORED ZIP ENTRY INSIDE IT), OR owned, WHICH loadNesData() COPIES
+            // INTO AND A COMPRESSED FILE INFLATES INTO. THE BANKS ARE SPANS INTO
+            // IT, NEVER COPIES, SO EVERY PROCESS RUNNING AN UNCOMPRESSED GAME
+            // SHARES ITS PAGES IN THE PAGE CACHE.
+            const mos6502::i8 *image;
+            size_t imageSize;
+            void *mapping;                      // FOR munmap(), NULL IF NOT MAPPED
+            size_t mappingSize;
+            std::unique_ptr<mos6502::i8[]> owned;
+
             // Trainer, if present (0 or 512 bytes)
 
             
             // PRG ROM data (16384 * x bytes)
-            std::vector<std::vector<mos6502::i8>> PRGROM;  // PRG ROM DATA(16384*SIZE)
+            size_t prgOffset;
+            size_t prgBanks;
 
             // CHR ROM data, if present (8192 * y bytes)
-            std::vector<std::vector<mos6502::i8>> CHRROM;  // CHR ROM DATA(8192*SIZE)
+            size_t chrOffset;
+            size_t chrBanks;
 
             // PlayChoice INST-ROM, if present (0 or 8192 bytes)
             // PlayChoice PROM, if present (16 bytes Data, 16 bytes CounterOut) (this is often missing, see PC10 ROM-Images for details)
 
 
             std::vector<std::string> mapperNames;
+            bool nes2;
+            bool verbose;
+
+            // VALIDATE THE HEADER OF image AND SET THE BANKS UP. -1 IF IT IS NOT
+            // iNES OR NES 2.0, OR THE FILE IS SHORTER THAN THE BANKS IT ANNOUNCES.
+            mos6502::i8 parse();
+            void unload();
+
+            // THE iNES IMAGE IN A .gz FILE OR (THE FIRST .nes ENTRY OF) A .zip,
+            // INFLATED STRAIGHT INTO owned: THE HEADER FIRST, TO SIZE IT, THEN
+            // THE BANKS. data IS THE WHOLE COMPRESSED FILE. expected IS THE
+            // SIZE THE ARCHIVE GIVES FOR THE IMAGE, WHICH CAPS THE ALLOCATION.
+            mos6502::i8 loadGzip(const mos6502::i8 *data, size_t size);
+            mos6502::i8 loadZip(const mos6502::i8 *data, size_t size);
+            mos6502::i8 inflateImage(const mos6502::i8 *data, size_t size, size_t expected, int windowBits, const uint32_t *crc);
+
+            // IT MAY OWN A MAPPING.
+            ROM(const ROM &);
+            ROM &operator=(const ROM &);
 
         public:
+
+            static const size_t PRG_BANK_SIZE = 16 * 1024;
+            static const size_t CHR_BANK_SIZE = 8 * 1024;
+
             ROM();
 
-            std::vector<std::vector<mos6502::i8>> getPRGROM(){return this->PRGROM;}
-            std::vector<std::vector<mos6502::i8>> getCHRROM(){return this->CHRROM;}
+            // PRG ROM IN 16 KB BANKS, CHR ROM IN 8 KB BANKS (NONE WITH CHR RAM).
+            size_t getPRGBanks() const{return this->prgBanks;}
+            size_t getCHRBanks() const{return this->chrBanks;}
+            Span getPRG(size_t bank) const{return Span(this->image + this->prgOffset + bank * PRG_BANK_SIZE, PRG_BANK_SIZE);}
+            Span getCHR(size_t bank) const{return Span(this->image + this->chrOffset + bank * CHR_BANK_SIZE, CHR_BANK_SIZE);}
+
+            // MAP AN iNES / NES 2.0 FILE READ ONLY (READ IT IN ONE GO WHERE THERE
+            // IS NO mmap). A GZIP FILE (.nes.gz) OR A ZIP ARCHIVE, TOLD APART BY
+            // THEIR MAGIC, IS INFLATED ON THE WAY IN, IN ONE PASS AND WITH NO
+            // TEMPORARY FILE; FROM A ZIP THE FIRST .nes ENTRY LOADS (OR THE ONLY
+            // ENTRY, WHATEVER ITS NAME). BUILT WITH -D NO_ZLIB THOSE FAIL.
             mos6502::i8 loadNesFile(const char* file);
+            // THE SAME FROM AN IMAGE ALREADY IN MEMORY (COPIED ONCE, SO data MAY
+            // GO AWAY). -1 IF size BYTES DO NOT HOLD THE HEADER AND EVERY BANK IT
+            // ANNOUNCES.
+            mos6502::i8 loadNesData(const mos6502::i8 *data, size_t size);
+
+            // CRC-32 OF THE PRG THEN CHR DATA, THE HEADER LEFT OUT, WHICH IS HOW
+            // ROM SETS IDENTIFY A GAME WHATEVER HEADER A DUMP CARRIES.
+            uint32_t getCRC32();
+            // SHA-1 OF THE SAME BYTES.
+            void getSHA1(mos6502::i8 digest[20]);
+
+            // THE PARSED HEADER.
+            mos6502::i8 getMapperType() const{return this->mapperType;}
+            mos6502::i8 getMirroring() const{return this->mirroring;}     // 0 HORIZONTAL, 1 VERTICAL
+            bool hasFourScreen() const{return this->fourScreen;}
+            bool hasBatteryRam() const{return this->batteryRam;}
+            bool hasTrainer() const{return this->trainer;}
+            bool isNES2() const{return this->nes2;}
+            TVSystem getTVSystem() const;
+            const mos6502::i8 *getHeader() const{return this->header;}
+
+            // PRINT THE HEADER, AND WHY A FILE DID NOT LOAD, WHEN LOADING (THE
+            // DEFAULT). TOOLS THAT LOAD MANY ROMS TURN IT OFF.
+            void setVerbose(bool verbose){this->verbose = verbose;}
 
 
             ~ROM();
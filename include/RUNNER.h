@@ -0,0 +1,133 @@
+#ifndef __RUNNER_H__
+#define __RUNNER_H__
+
+#include "MOS6502.h"
+#include "ROM.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <deque>
+#include <iostream>
+
+namespace runner{
+
+    /**
+     * HEADLESS BATCH RUNNER.
+     *
+     * RUNS A LIST OF INDEPENDENT JOBS (ROM, INPUT MOVIE, FRAME COUNT), EACH ON
+     * ITS OWN cpu::CPU, ACROSS A POOL OF WORKER THREADS. EVERY WORKER OWNS A
+     * DEQUE OF JOB INDICES: IT TAKES WORK FROM THE BACK OF ITS OWN AND, WHEN
+     * THAT RUNS DRY, STEALS FROM THE FRONT OF THE OTHERS. JOBS ARE COARSE (A
+     * WHOLE RUN), SO A MUTEX PER DEQUE IS NEVER CONTENDED ENOUGH TO MATTER.
+     *
+     * ROM IMAGES ARE LOADED ONCE PER PATH, BY WHICHEVER WORKER NEEDS ONE FIRST,
+     * AND SHARED READ-ONLY: EVERY MACHINE'S MAPPER POINTS ITS $8000-$FFFF
+     * PAGES STRAIGHT INTO THE MAPPED FILE, BANK SWITCHES INCLUDED, SO N JOBS
+     * ON ONE ROM COST ONE COPY OF IT. NOTHING IS WRITTEN TO SHARED STATE WHILE
+     * A JOB RUNS; EACH WORKER KEEPS ITS OWN COUNTERS ON ITS OWN CACHE LINE.
+     *
+     * WITH options.rewind SET EVERY JOB ALSO PUSHES EACH FRAME INTO ITS OWN
+     * REWIND BUFFER, WHICH IS WHAT SEARCH TOOLS RUNNING ON TOP OF IT PAY FOR.
+     *
+     * THE MOVIE IS AN INPUT MOVIE (SEE MOVIE.h) RECORDED ON THE SAME ROM. ITS
+     * INPUTS DRIVE THE JOYPADS AND EVERY KEYFRAME IT CROSSES IS COMPARED WITH
+     * THE LIVE MACHINE, SO A BATCH OF MOVIES DOUBLES AS A DETERMINISM CHECK.
+     * FRAMES PAST ITS END RUN WITH NO BUTTONS HELD.
+     */
+
+    struct Job{
+        std::string rom;
+        std::string movie;          // EMPTY FOR NO INPUT, SEE MOVIE.h
+        uint32_t    frames;
+    };
+
+    struct Result{
+        uint32_t frames;            // FRAMES ACTUALLY RUN, 0 IF THE ROM OR MOVIE DID NOT LOAD
+        uint64_t cycles;
+        double   seconds;
+        int      worker;
+        mos6502::i16 pc;            // WHERE THE MACHINE STOPPED
+        uint32_t rewindFrames;      // FRAMES OF REWIND HISTORY HELD AT THE END, 0 WITHOUT ONE
+        uint32_t keyframes;         // MOVIE KEYFRAMES CHECKED
+        uint32_t desyncs;           // ... THAT DID NOT MATCH THE MACHINE
+    };
+
+    // PER WORKER TOTALS. THE TRAILING PAD KEEPS NEIGHBOURS A CACHE LINE
+    // APART HOWEVER THE ARRAY ENDS UP ALIGNED, SO WORKERS NEVER SHARE ONE.
+    struct WorkerStats{
+        uint64_t jobs;
+        uint64_t frames;
+        uint64_t cycles;
+        uint64_t steals;
+        double   seconds;           // TIME SPENT RUNNING JOBS
+        mos6502::i8 padding[64];
+    };
+
+    // A LOADED ROM AS THE MACHINES SEE IT, IMMUTABLE ONCE LOADED.
+    struct Image{
+        bool loaded;
+        uint32_t crc;               // rom::ROM::getCRC32(), WHAT MOVIES ARE CHECKED AGAINST
+        rom::ROM rom;               // EVERY JOB'S mapper::Mapper READS IT, NONE WRITES
+    };
+
+    struct Options{
+        int  threads;               // 0 FOR ONE PER HARDWARE THREAD
+        bool jit;
+        bool idleSkip;
+        bool pin;                   // PIN WORKER i TO CPU i WHERE SUPPORTED
+        size_t rewind;              // BYTES OF REWIND HISTORY PER JOB, 0 FOR NONE (SEE REWIND.h)
+    };
+
+    // ONE JOB PER LINE: <rom> <frames> [movie]. BLANK LINES AND # COMMENTS ARE
+    // SKIPPED. FALSE, WITH error SET, ON THE FIRST MALFORMED LINE.
+    bool parseJobs(std::istream &in, std::vector<Job> &jobs, std::string &error);
+
+    class Runner{
+
+        private:
+
+            struct Queue{
+                std::mutex mutex;
+                std::deque<size_t> jobs;
+                mos6502::i8 padding[64];    // SEE WorkerStats
+            };
+
+            struct Slot{
+                std::once_flag once;
+                std::shared_ptr<Image> image;
+            };
+
+            Options options;
+            std::vector<Job> jobs;
+            std::vector<Result> results;
+            std::vector<WorkerStats> stats;
+            std::unique_ptr<Queue[]> queues;
+            int workers;
+
+            std::mutex imagesMutex;
+            std::map<std::string, std::unique_ptr<Slot> > images;
+
+            bool take(int worker, size_t &job);
+            std::shared_ptr<Image> image(const std::string &path);
+            void work(int worker);
+            void runJob(int worker, size_t job);
+
+        public:
+
+            Runner(const Options &options);
+
+            // RUN EVERY JOB TO COMPLETION. RESULTS COME BACK IN JOB ORDER.
+            const std::vector<Result> &run(const std::vector<Job> &jobs);
+
+            int getWorkers() const{return this->workers;}
+            const std::vector<WorkerStats> &getStats() const{return this->stats;}
+            size_t getImages() const{return this->images.size();}
+
+            ~Runner();
+    };
+
+};
+
+#endif // !__RUNNER_H__
@@ -0,0 +1,115 @@
+#ifndef __STATE_H__
+#define __STATE_H__
+
+#include "MOS6502.h"
+#include <stddef.h>
+#include <string.h>
+
+namespace state{
+
+    /**
+     * MACHINE STATE ARENA.
+     *
+     * EVERYTHING THE EMULATED MACHINE CAN CHANGE LIVES IN ONE CACHE LINE
+     * ALIGNED, TRIVIALLY COPYABLE Machine: THE CPU REGISTERS (cpu::CPU INHERITS
+     * THEM), THE MEMORY BEHIND THE BUS AND THE CONTROLLER PORTS. A SNAPSHOT IS
+     * A PLAIN COPY AND A RESTORE IS ANOTHER, NO POINTERS TO FIX UP.
+     *
+     * WHAT IS NOT IN HERE IS EITHER READ ONLY (PRG) OR DERIVED FROM WHAT IS
+     * (PAGE TABLE, BLOCK CACHE, JIT CODE) AND REBUILT BY cpu::CPU::loadState().
+     * THE PPU AND APU HAVE NO STATE YET. WHEN THEY GROW SOME, IT GETS ITS OWN
+     * SECTION AT THE END OF Machine AND VERSION GOES UP.
+     */
+
+    // WORK RAM, SRAM AND THE MMIO LATCHES BEHIND THE DEFAULT BUS HANDLERS.
+    struct Memory{
+        mos6502::i8 ram[0x800];
+        mos6502::i8 sram[0x2000];
+        mos6502::i8 ppuLatch[0x8];
+        mos6502::i8 ioLatch[0x20];
+        mos6502::i8 padding[64 - (0x800 + 0x2000 + 0x8 + 0x20) % 64];
+    };
+
+    // THE TWO CONTROLLER PORTS, SEE joypads.h.
+    struct Pads{
+        mos6502::i8 buttons[2];     // WHAT IS HELD NOW, A IN BIT 0 ... RIGHT IN BIT 7
+        mos6502::i8 shift[2];       // WHAT THE NEXT READS OF $4016/$4017 SHIFT OUT
+        mos6502::i8 strobe;         // BIT 0 OF THE LAST $4016 WRITE
+        mos6502::i8 padding[64 - 5];
+    };
+
+    // THE CARTRIDGE'S MAPPER, SEE MAPPER.h. THE BANKS ARE WHAT IS MAPPED, IN
+    // UNITS OF THE SLOT SIZE; regs IS WHATEVER ELSE THE MAPPER KEEPS.
+    struct Cart{
+        uint16_t prg[4];            // 8 KB AT $8000, $A000, $C000, $E000
+        uint16_t chr[8];            // 1 KB AT PPU $0000, $0400 ... $1C00
+        mos6502::i8 mirroring;      // mapper::Mirroring
+        mos6502::i8 irq;            // THE CART HOLDS /IRQ LOW
+        mos6502::i8 regs[32];
+        mos6502::i8 padding[64 - (4 * 2 + 8 * 2 + 2 + 32)];
+    };
+
+    struct alignas(64) Machine{
+        /**************************CPU**************************/
+        mos6502::i16 PC;
+        mos6502::i16 SP;                // 0X100 - 0X1FF , GROES DOWNWORDS.
+        mos6502::i8  P;                 // ONLY I AND D, SEE THE LAZY FLAGS BELOW
+        mos6502::i8  A;
+        mos6502::i8  X;
+        mos6502::i8  Y;
+
+        // N/Z/C/V AS cpu::CPU KEEPS THEM, SEE CPU.h.
+        mos6502::i8  flagN;
+        mos6502::i8  flagZ;
+        mos6502::i16 flagC;
+        mos6502::i8  flagVA;
+        mos6502::i8  flagVM;
+        mos6502::i8  flagVR;
+
+        uint32_t frameOvershoot;        // CYCLES THE LAST runFrame() BORROWED FROM THE NEXT ONE
+        uint64_t cycles;                // MASTER CLOCK, CPU CYCLES SINCE POWER-ON
+
+        /**************************MEMORY**************************/
+        alignas(64) Memory memory;
+
+        /**************************INPUT**************************/
+        Pads pads;
+
+        /**************************CARTRIDGE**************************/
+        Cart cart;
+
+        // PADDING INCLUDED, SO TWO MACHINES IN THE SAME STATE COMPARE EQUAL
+        // BYTE FOR BYTE (MOVIE KEYFRAMES RELY ON IT).
+        Machine(){
+            memset(this, 0, sizeof(*this));
+            this->SP    = 0xFF;
+            this->flagZ = 1;
+        }
+    };
+
+    // cpu::CPU INHERITS Machine, AND THE ABI MAY PLACE A DERIVED CLASS'S OWN
+    // MEMBERS IN ITS BASE'S TAIL PADDING, WHERE A memcpy OF sizeof(Machine)
+    // WOULD CLOBBER THEM. THE SECTIONS ARE PADDED SO THERE IS NONE.
+    static_assert(sizeof(Memory) % 64 == 0, "state::Memory must end on a cache line");
+    static_assert(sizeof(Pads) % 64 == 0, "state::Pads must end on a cache line");
+    static_assert(sizeof(Cart) % 64 == 0, "state::Cart must end on a cache line");
+
+    // ON DISK: A Header, THEN THE RAW Machine. THE LAYOUT IS THE HOST'S, SO A
+    // FILE ONLY LOADS ON A BUILD WITH THE SAME VERSION AND sizeof(Machine).
+    static const uint32_t MAGIC   = 0x5353454E;    // "NESS"
+    static const uint32_t VERSION = 3;
+
+    struct Header{
+        uint32_t magic;
+        uint32_t version;
+        uint32_t size;                  // sizeof(Machine)
+        uint32_t reserved;
+    };
+
+    // 0 ON SUCCESS, -1 IF THE FILE CANNOT BE WRITTEN/READ OR DOES NOT MATCH.
+    int saveFile(const char *path, const Machine &machine);
+    int loadFile(const char *path, Machine &machine);
+
+};
+
+#endif // !__STATE_H__
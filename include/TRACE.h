@@ -0,0 +1,212 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include "MOS6502.h"
+#include <vector>
+#include <iostream>
+
+namespace trace{
+
+    /**
+     * TRACE POLICIES FOR CPU::runCycles<Trace>().
+     *
+     * THE CORE CALLS trace.record(...) ONCE PER INSTRUCTION, AFTER DECODE AND
+     * BEFORE THE HANDLER RUNS, SO REGISTERS ARE THE PRE-EXECUTION STATE (THE
+     * SAME CONVENTION AS NESTEST LOGS). cycle IS THE CPU MASTER CLOCK AT THAT
+     * POINT, SO PENALTIES OF EARLIER INSTRUCTIONS ARE ALREADY IN IT.
+     *
+     *   NoTrace     : EMPTY INLINE HOOK, THE PRODUCTION CORE COMPILES IT OUT.
+     *   BinaryTrace : FIXED-SIZE RECORDS INTO A PREALLOCATED RING BUFFER.
+     *   TextTrace   : FORMATS EVERY RECORD TO A STREAM AS IT HAPPENS (SLOW).
+     *   CountTrace  : COUNTS INSTRUCTIONS. IT RECORDS, SO IDLE LOOPS AND NATIVE
+     *                 BLOCKS RUN INSTRUCTION BY INSTRUCTION AND EVERY ONE COUNTS.
+     *   Profile     : EXECUTIONS AND CYCLES PER OPCODE AND PER PC (SEE BELOW).
+     */
+
+    // ONE EXECUTED INSTRUCTION, 24 BYTES ON DISK AND IN MEMORY.
+    struct Record{
+        uint64_t     cycle;      // CYCLES BEFORE THIS INSTRUCTION
+        mos6502::i16 pc;
+        mos6502::i16 operand;
+        mos6502::i8  op;
+        mos6502::i8  A;
+        mos6502::i8  X;
+        mos6502::i8  Y;
+        mos6502::i8  P;
+        mos6502::i8  SP;
+        mos6502::i8  reserved[6];
+    };
+
+    // WRITE ONE RECORD AS A SINGLE LINE OF TEXT.
+    void format(const Record &record, std::ostream &out);
+
+    // FORMAT A FILE WRITTEN BY BinaryTrace::flush(), OFFLINE.
+    bool formatFile(const char *file, std::ostream &out);
+
+
+    class NoTrace{
+        public:
+            static const bool RECORDS = false;      // NATIVE BLOCKS MAY SKIP record()
+            inline void record(mos6502::i16 pc, mos6502::i8 op, mos6502::i16 operand,
+                               mos6502::i8 A, mos6502::i8 X, mos6502::i8 Y,
+                               mos6502::i8 P, mos6502::i8 SP, uint64_t cycle){
+            }
+    };
+
+
+    class CountTrace{
+        public:
+            static const bool RECORDS = true;
+            uint64_t count = 0;
+            inline void record(mos6502::i16 pc, mos6502::i8 op, mos6502::i16 operand,
+                               mos6502::i8 A, mos6502::i8 X, mos6502::i8 Y,
+                               mos6502::i8 P, mos6502::i8 SP, uint64_t cycle){
+                this->count++;
+            }
+    };
+
+    /**
+     * EXECUTION PROFILE. FLAT COUNTERS PER OPCODE (INDEXED LIKE
+     * cpu::CPU::opTable) AND PER CODE LOCATION, SO A RECORD IS FOUR ADDS AND
+     * NO LOOKUP. LIKE ANY POLICY IT COSTS NOTHING UNLESS runCycles() IS GIVEN
+     * ONE.
+     *
+     * A LOCATION BELOW $8000 IS THE PC. FROM $8000 IT IS THE PRG BANK MAPPED
+     * IN THE PC'S 8 KB SLOT (state::Cart::prg) AND THE OFFSET IN IT, $8000 +
+     * BANK * $2000 + OFFSET, SO CODE IS COUNTED WHERE IT IS IN THE ROM
+     * HOWEVER THE MAPPER SWITCHES IT. WITHOUT A CART SLOT N SHOWS BANK N, AND
+     * THE LOCATION IS THE PC.
+     *
+     * AN INSTRUCTION'S CYCLES ARE ONLY KNOWN WHEN THE NEXT ONE STARTS, SO EACH
+     * record() CHARGES THE PREVIOUS INSTRUCTION; finish() CHARGES THE LAST.
+     * INTERRUPT ENTRY IS CHARGED TO THE INSTRUCTION BEFORE IT.
+     */
+    class Profile{
+
+        public:
+
+            struct Counter{
+                uint64_t executions;
+                uint64_t cycles;
+            };
+
+            static const bool RECORDS = true;
+
+            static const uint32_t OPS = 256;
+            static const uint32_t PRG = 0x8000;     // THE FIRST PRG LOCATION
+            static const uint32_t BANK_SIZE = 0x2000;
+
+            // ONE SPARE ENTRY AT THE END OF EACH, SEE lastOp.
+            std::vector<Counter> ops;
+            std::vector<Counter> pcs;               // BY LOCATION
+
+            // banks IS THE CPU'S state::Cart::prg (cpu::CPU::getCart()), WHICH
+            // THE MAPPER KEEPS BELOW prgBanks, ITS COUNT OF 8 KB BANKS.
+            Profile(const uint16_t *banks = NULL, uint32_t prgBanks = 4);
+
+            inline void record(mos6502::i16 pc, mos6502::i8 op, mos6502::i16 operand,
+                               mos6502::i8 A, mos6502::i8 X, mos6502::i8 Y,
+                               mos6502::i8 P, mos6502::i8 SP, uint64_t cycle){
+                uint32_t location = pc < PRG ? pc : PRG + this->banks[pc >> 13 & 3] * BANK_SIZE + (pc & (BANK_SIZE - 1));
+                uint64_t spent = cycle - this->lastCycle;
+                this->ops[this->lastOp].cycles += spent;
+                this->pcs[this->lastPC].cycles += spent;
+                this->ops[op].executions++;
+                this->pcs[location].executions++;
+                this->lastOp    = op;
+                this->lastPC    = location;
+                this->lastCycle = cycle;
+            }
+
+            // CHARGE THE LAST INSTRUCTION, cycle BEING THE CPU CLOCK NOW. CALL
+            // IT BEFORE READING THE COUNTERS; RECORDING MAY GO ON AFTERWARDS.
+            void finish(uint64_t cycle);
+
+            void clear();
+
+            // HOTTEST top OPCODES, LOCATIONS AND PRG BANKS BY CYCLES, AS TEXT.
+            void report(std::ostream &out, int top = 20) const;
+
+            // GREY PGM 256 PIXELS WIDE, ONE PIXEL PER LOCATION, LOG SCALED
+            // CYCLES: $0000-$7FFF THEN EACH PRG BANK, 64 KIB FOR 32 KB OF PRG.
+            bool heatmap(const char *file) const;
+
+        private:
+
+            static const uint16_t IDENTITY[4];
+
+            const uint16_t *banks;
+            uint32_t locations;
+
+            // THE INSTRUCTION NOT YET CHARGED. BEFORE THE FIRST RECORD IT IS
+            // THE SPARE ENTRIES (OPS, locations), SO record() NEEDS NO BRANCH.
+            uint32_t lastOp;
+            uint32_t lastPC;
+            uint64_t lastCycle;
+    };
+
+    class BinaryTrace{
+
+        private:
+
+            std::vector<Record> ring;
+            uint64_t mask;
+            uint64_t head = 0;           // TOTAL RECORDS WRITTEN
+
+        public:
+
+            static const bool RECORDS = true;
+
+            // CAPACITY IS ROUNDED UP TO A POWER OF TWO.
+            BinaryTrace(uint64_t capacity = 1 << 16);
+
+            inline void record(mos6502::i16 pc, mos6502::i8 op, mos6502::i16 operand,
+                               mos6502::i8 A, mos6502::i8 X, mos6502::i8 Y,
+                               mos6502::i8 P, mos6502::i8 SP, uint64_t cycle){
+                Record &r = this->ring[this->head & this->mask];
+                r.cycle   = cycle;
+                r.pc      = pc;
+                r.operand = operand;
+                r.op      = op;
+                r.A       = A;
+                r.X       = X;
+                r.Y       = Y;
+                r.P       = P;
+                r.SP      = SP;
+                this->head++;
+            }
+
+            // RECORDS CURRENTLY HELD, OLDEST FIRST. index 0 IS THE OLDEST.
+            uint64_t size() const;
+            const Record &at(uint64_t index) const;
+
+            // WRITE THE HELD RECORDS AS RAW BINARY AND EMPTY THE RING.
+            void flush(std::ostream &out);
+
+            // WRITE THE HELD RECORDS AS TEXT.
+            void format(std::ostream &out) const;
+
+            void clear();
+    };
+
+
+    class TextTrace{
+
+        private:
+
+            std::ostream &out;
+
+        public:
+
+            static const bool RECORDS = true;
+
+            TextTrace(std::ostream &out) : out(out){}
+
+            void record(mos6502::i16 pc, mos6502::i8 op, mos6502::i16 operand,
+                        mos6502::i8 A, mos6502::i8 X, mos6502::i8 Y,
+                        mos6502::i8 P, mos6502::i8 SP, uint64_t cycle);
+    };
+
+};
+
+#endif // !__TRACE_H__
@@ -1,22 +1,56 @@
 #ifndef __JOYPADS_H__
 #define __JOYPADS_H__
 
-
+#include "MOS6502.h"
+#include "STATE.h"
+#include "BUS.h"
 
 namespace nes{
 
+    /**
+     * STANDARD CONTROLLERS ON $4016 (PORT 0) AND $4017 (PORT 1).
+     *
+     * WRITING 1 TO BIT 0 OF $4016 HOLDS BOTH SHIFT REGISTERS LOADED WITH THE
+     * BUTTONS; WRITING 0 RELEASES THEM. EACH READ THEN RETURNS THE NEXT BUTTON
+     * IN BIT 0 (A, B, SELECT, START, UP, DOWN, LEFT, RIGHT), THEN 1S. BITS 5-7
+     * ARE OPEN BUS, WHICH IS THE HIGH ADDRESS BYTE ($40) HERE.
+     *
+     * THE PORTS LIVE IN THE STATE ARENA, SO SAVESTATES, REWIND AND MOVIE
+     * KEYFRAMES CARRY THEM. THE REST OF THE IO PAGE GOES ON TO THE BUS LATCHES.
+     * A BARE cpu::CPU WITHOUT JOYPADS KEEPS SEEING $4016 AS A PLAIN LATCH.
+     */
     class JoyPads{
 
         private:
 
+            bus::Bus *bus;
+            state::Pads *pads;
+
+            static mos6502::i8 read(void *context, mos6502::i16 addr);
+            static void write(void *context, mos6502::i16 addr, mos6502::i8 data);
 
         public:
 
+            enum Button{
+                A      = 0x01,
+                B      = 0x02,
+                SELECT = 0x04,
+                START  = 0x08,
+                UP     = 0x10,
+                DOWN   = 0x20,
+                LEFT   = 0x40,
+                RIGHT  = 0x80,
+            };
+
+            // MAP OVER THE IO PAGE OF bus, KEEPING THE PORTS IN pads.
+            JoyPads(bus::Bus &bus, state::Pads &pads);
+
+            // BUTTONS HELD ON port (0 OR 1) FROM NOW ON, A BITMASK OF Button.
+            void set(int port, mos6502::i8 buttons);
+            mos6502::i8 get(int port){return this->pads->buttons[port & 1];}
+
+            ~JoyPads();
     };
 };
 
-
-
-
-
 #endif // ! __JOYPADS_H__
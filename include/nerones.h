@@ -0,0 +1,102 @@
+#ifndef __NERONES_H__
+#define __NERONES_H__
+
+/**
+ * C API OF libnerones.so (make so).
+ *
+ * PLAIN C, NO C++ TYPES OR EXCEPTIONS CROSS IT, AND THE LIBRARY EXPORTS
+ * NOTHING ELSE, SO ANY LANGUAGE WITH A C FFI CAN DRIVE THE EMULATOR. FUNCTIONS
+ * ARE ONLY EVER ADDED; A CHANGE TO AN EXISTING ONE BUMPS NERONES_API_VERSION.
+ *
+ * THE FRAMEBUFFER AND RAM POINTERS POINT INTO THE INSTANCE ITSELF: READING
+ * THEM AFTER A STEP COPIES NOTHING. THEY STAY VALID, AND KEEP POINTING AT THE
+ * LIVE MACHINE, UNTIL nerones_destroy(), LOADING ANOTHER ROM INCLUDED. AN
+ * INSTANCE IS NOT THREAD SAFE; SEPARATE INSTANCES ARE INDEPENDENT.
+ *
+ *     nerones *nes = nerones_create();
+ *     nerones_load_file(nes, "game_rom/donkykong.nes");
+ *     const uint8_t *pixels = nerones_framebuffer(nes);
+ *     const uint8_t *ram = nerones_ram(nes);
+ *     for(;;){
+ *         uint8_t input[2] = {NERONES_START, 0};
+ *         nerones_step(nes, input, 1);
+ *         ... pixels AND ram NOW HOLD THIS FRAME ...
+ *     }
+ *     nerones_destroy(nes);
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define NERONES_API __declspec(dllexport)
+#else
+#define NERONES_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NERONES_API_VERSION 1
+
+#define NERONES_WIDTH    256
+#define NERONES_HEIGHT   240
+#define NERONES_RAM_SIZE 2048
+
+/* CONTROLLER BITS, AS nes::JoyPads::Button. */
+#define NERONES_A      0x01
+#define NERONES_B      0x02
+#define NERONES_SELECT 0x04
+#define NERONES_START  0x08
+#define NERONES_UP     0x10
+#define NERONES_DOWN   0x20
+#define NERONES_LEFT   0x40
+#define NERONES_RIGHT  0x80
+
+typedef struct nerones nerones;
+
+/* NERONES_API_VERSION OF THE LIBRARY ACTUALLY LOADED. */
+NERONES_API uint32_t nerones_api_version(void);
+
+/* NULL IF OUT OF MEMORY. */
+NERONES_API nerones *nerones_create(void);
+NERONES_API void nerones_destroy(nerones *nes);
+
+/* LOAD AN iNES ROM AND POWER ON. 0 ON SUCCESS, -1 ON A BAD OR MISSING ROM,
+   WHICH LEAVES THE INSTANCE WITHOUT ONE. nerones_load_memory COPIES data. */
+NERONES_API int nerones_load_file(nerones *nes, const char *path);
+NERONES_API int nerones_load_memory(nerones *nes, const uint8_t *data, size_t size);
+
+/* POWER CYCLE THE LOADED ROM. -1 WITHOUT ONE. */
+NERONES_API int nerones_reset(nerones *nes);
+
+/* KEEP THE LOADED ROM'S BATTERY RAM IN THE FILE path (CREATED IF MISSING),
+   WRITTEN BEHIND ON A BACKGROUND THREAD. CALL IT RIGHT AFTER LOADING. -1
+   WITHOUT A ROM, IF IT HAS NO BATTERY, OR IF path CANNOT BE OPENED. */
+NERONES_API int nerones_open_save(nerones *nes, const char *path);
+
+/* RUN frames FRAMES. inputs HOLDS 2 BYTES PER FRAME (PORT 0, PORT 1) OF
+   NERONES_* BITS; NULL KEEPS THE BUTTONS OF THE LAST FRAME HELD. RETURNS THE
+   CPU CYCLES RUN, 0 WITHOUT A ROM. */
+NERONES_API uint64_t nerones_step(nerones *nes, const uint8_t *inputs, uint32_t frames);
+
+/* NERONES_WIDTH * NERONES_HEIGHT COLOUR INDICES (0-63), ROW MAJOR. */
+NERONES_API const uint8_t *nerones_framebuffer(nerones *nes);
+
+/* 0xRRGGBB OF THE 64 COLOUR INDICES. */
+NERONES_API const uint32_t *nerones_palette(void);
+
+/* THE NERONES_RAM_SIZE BYTES OF WORK RAM ($0000-$07FF), READ ONLY; CHANGE
+   IT WITH nerones_poke(). */
+NERONES_API const uint8_t *nerones_ram(nerones *nes);
+
+/* WRITE value TO CPU ADDRESS addr AS A STORE BY THE GAME WOULD, SO CODE THE
+   EMULATOR CACHED FROM THAT PAGE IS DROPPED. */
+NERONES_API void nerones_poke(nerones *nes, uint16_t addr, uint8_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !__NERONES_H__
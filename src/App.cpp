@@ -14,14 +14,23 @@ App::App() {
 
 
 void App::OnEvent(SDL_Event* Event) {
-
+    if(Event->type == SDL_KEYDOWN || Event->type == SDL_KEYUP) {
+        if(Event->key.keysym.sym == SDLK_BACKSPACE) {
+            Rewinding = Event->type == SDL_KEYDOWN;
+        }
+    }
 }
 
 bool App::Init() {
-    this->ppu = new ppu::PPU(); 
-    this->rom = new rom::ROM();
-    this->rom->loadNesFile("game_rom/donkykong.nes");
-
+    this->nes = new nes::NES();
+    if(this->nes->loadRom("game_rom/donkykong.nes") != 0) {
+        Log("Unable to load the PRG ROM");
+        return false;
+    }
+    if(this->nes->getROM()->hasBatteryRam() && this->nes->openSave("game_rom/donkykong.sav") != 0) {
+        Log("Unable to open the save file");
+    }
+    this->rewind = new history::Buffer(RewindBytes);
 
 
     if(SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -60,18 +69,27 @@ bool App::Init() {
 
 
 void App::Loop() {
-
+    if(Rewinding) {
+        state::Machine machine;
+        if(this->rewind->rewind(1, machine)) {
+            this->nes->getCPU()->loadState(machine);
+        }
+        return;
+    }
+    this->nes->stepFrame();
+    this->rewind->push(this->nes->getCPU()->getState());
 }
 #include <iostream>
 void App::Render() {
    
 
     // get CHR rom
-    std::vector<mos6502::i8> rom = this->rom->getPRGROM()[0];
+    rom::Span rom = this->nes->getROM()->getPRG(0);
+    ppu::PPU *ppu = this->nes->getPPU();
     
     // process CHR mata data
     std::vector<ppu::Tile> tiles;
-    for(int i = 0; i < (int)rom.size()-15; i+=16){
+    for(int i = 0; i < (int)rom.size-15; i+=16){
         
         ppu::Tile tile;
         
@@ -91,9 +109,11 @@ void App::Render() {
    
 
     // GAME RENDER AREA
+    const mos6502::i8 *frame = this->nes->framebuffer();
     for(int i = 0; i< WindowWidth/4; i++){
         for(int j = 0; j<WindowHeight/4; j++){
-            SDL_SetRenderDrawColor(Renderer, i, j, 0, 255);
+            uint32_t rgb = ppu::PALETTE[frame[j * nes::NES::WIDTH + i] & 0x3F];
+            SDL_SetRenderDrawColor(Renderer, rgb >> 16, (rgb >> 8) & 0xFF, rgb & 0xFF, 255);
             SDL_Rect rect{
                 i*2,
                 j*2,
@@ -179,6 +199,11 @@ void App::Render() {
 }
 
 void App::Cleanup() {
+    delete this->rewind;
+    this->rewind = NULL;
+    delete this->nes;
+    this->nes = NULL;
+
     if(Renderer) {
         SDL_DestroyRenderer(Renderer);
         Renderer = NULL;                    
@@ -0,0 +1,150 @@
+#include "../include/BATTERY.h"
+#include <chrono>
+#include <string.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+namespace battery{
+
+    Save::Save(){
+        this->sram     = NULL;
+        this->size     = 0;
+        this->file     = NULL;
+        this->fd       = -1;
+        this->interval = INTERVAL;
+        this->pending  = false;
+        this->stopping = false;
+        memset(&this->stats, 0, sizeof(this->stats));
+    }
+
+    Save::~Save(){
+        this->close();
+    }
+
+    int Save::open(const char *path, mos6502::i8 *sram, size_t size, uint32_t interval){
+        this->close();
+#ifndef WIN32
+        int fd = ::open(path, O_RDWR | O_CREAT, 0644);
+        struct stat info;
+        if(fd < 0 || fstat(fd, &info) != 0 || ((size_t)info.st_size < size && ftruncate(fd, size) != 0)){
+            if(fd >= 0){
+                ::close(fd);
+            }
+            return -1;
+        }
+        void *mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(mapped == MAP_FAILED){
+            ::close(fd);
+            return -1;
+        }
+        this->fd   = fd;
+        this->file = (mos6502::i8 *)mapped;
+#else
+        // A HEAP COPY STANDS IN FOR THE MAPPING, persist() WRITES IT OUT WHOLE.
+        this->file = new mos6502::i8[size];
+        memset(this->file, 0, size);
+        std::ifstream in(path, std::ios::binary);
+        if(in){
+            in.read((char *)this->file, size);
+        }
+        this->path = path;
+#endif
+        this->sram     = sram;
+        this->size     = size;
+        this->interval = interval;
+        this->shadow.assign(this->file, this->file + size);
+        this->pending  = false;
+        this->stopping = false;
+        memcpy(this->sram, this->file, size);
+        this->flusher = std::thread(&Save::run, this);
+        return 0;
+    }
+
+    void Save::update(bool block){
+        if(this->file == NULL || memcmp(this->sram, &this->shadow[0], this->size) == 0){
+            return;
+        }
+        std::unique_lock<std::mutex> lock(this->mutex, std::defer_lock);
+        if(block){
+            lock.lock();
+        }else if(!lock.try_lock()){
+            this->stats.deferred++;
+            return;
+        }
+        memcpy(&this->shadow[0], this->sram, this->size);
+        this->pending = true;
+        this->stats.updates++;
+    }
+
+    void Save::load(){
+        if(this->file == NULL){
+            return;
+        }
+        // ONLY THIS THREAD WRITES shadow, SO READING IT NEEDS NO LOCK.
+        memcpy(this->sram, &this->shadow[0], this->size);
+    }
+
+    // THE FLUSHER. THE SHADOW IS ONLY HELD FOR THE COPY, NEVER ACROSS THE DISK.
+    void Save::run(){
+        std::unique_lock<std::mutex> lock(this->mutex);
+        while(!this->stopping){
+            this->wake.wait_for(lock, std::chrono::milliseconds(this->interval));
+            if(!this->pending){
+                continue;
+            }
+            memcpy(this->file, &this->shadow[0], this->size);
+            this->pending = false;
+            this->stats.syncs++;
+            lock.unlock();
+            this->persist();
+            lock.lock();
+        }
+    }
+
+    int Save::persist(){
+#ifndef WIN32
+        return msync(this->file, this->size, MS_SYNC);
+#else
+        std::ofstream out(this->path.c_str(), std::ios::binary | std::ios::trunc);
+        out.write((const char *)this->file, this->size);
+        return out ? 0 : -1;
+#endif
+    }
+
+    Stats Save::getStats(){
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->stats;
+    }
+
+    void Save::close(){
+        if(this->file == NULL){
+            return;
+        }
+        this->update(true);
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->wake.notify_one();
+        this->flusher.join();
+        memcpy(this->file, &this->shadow[0], this->size);
+        this->stats.syncs++;
+        this->persist();
+#ifndef WIN32
+        munmap(this->file, this->size);
+        ::close(this->fd);
+#else
+        delete[] this->file;
+#endif
+        this->file = NULL;
+        this->fd   = -1;
+        this->sram = NULL;
+        std::vector<mos6502::i8>().swap(this->shadow);
+    }
+};
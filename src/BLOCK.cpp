@@ -0,0 +1,154 @@
+#include "../include/BLOCK.h"
+#include "../include/CPU.h"
+#include <string.h>
+
+namespace block{
+
+    Block Cache::empty;
+
+    Cache::Cache(bus::Bus &bus) : blocks(CACHE_SIZE), bus(&bus){
+        this->current = &empty;
+        this->index = 0;
+        this->flush();
+        this->resetStats();
+        this->bus->setCodeWriteHandler(&Cache::codeWritten, this);
+        this->bus->setRemapHandler(&Cache::remapped, this);
+    }
+
+    // OPCODES AFTER WHICH THE NEXT PC IS NOT PC + bytes.
+    static bool endsBlock(mos6502::i8 op){
+        switch(op){
+            case 0x00:                      // BRK
+            case 0x20:                      // JSR
+            case 0x40:                      // RTI
+            case 0x4C: case 0x6C:           // JMP
+            case 0x60:                      // RTS
+                return true;
+        }
+        return (op & 0x1F) == 0x10;         // BRANCHES
+    }
+
+    void Cache::build(Block &block, mos6502::i16 pc, const mos6502::i8 *host){
+        block.host         = host;
+        block.native       = NULL;
+        block.pc           = pc;
+        block.count        = 0;
+        block.nativeCount  = 0;
+        block.nativeCycles = 0;
+        block.writable     = this->bus->isWritable(pc);
+        block.heat         = 0;
+
+        // EVERY BYTE OF EVERY INSTRUCTION STAYS INSIDE THE KEYED PAGE, SO THE
+        // KEY DESCRIBES THE WHOLE BLOCK.
+        int offset = pc & 0xFF;
+        while(block.count < BLOCK_SIZE){
+            mos6502::i8 op = host[offset];
+            int bytes = cpu::CPU::opTable[op].bytes;
+            if(offset + bytes > 0x100){
+                break;
+            }
+            Instruction &ins = block.ins[block.count++];
+            ins.pc      = (pc & 0xFF00) | offset;
+            ins.op      = op;
+            ins.operand = 0;
+            if(bytes >= 2){
+                ins.operand = host[offset + 1];
+            }
+            if(bytes == 3){
+                ins.operand |= host[offset + 2] << 8;
+            }
+            offset += bytes;
+            if(endsBlock(op)){
+                break;
+            }
+        }
+
+        block.idle = this->isPollLoop(block);
+
+        if(block.count && block.writable){
+            this->bus->watchCode(host);
+            this->writableCode = true;
+        }
+    }
+
+    // A SHORT BLOCK THAT ENDS IN A BRANCH BACK TO ITS OWN START AND OTHERWISE
+    // ONLY READS PLAIN MEMORY (OR PPUSTATUS) AND TOUCHES REGISTERS. WHETHER IT
+    // REALLY SPINS IS DECIDED AT RUN TIME BY CPU::idle().
+    bool Cache::isPollLoop(const Block &block){
+        if(block.count < 2 || block.count > 8){
+            return false;
+        }
+        const Instruction &last = block.ins[block.count - 1];
+        if((last.op & 0x1F) != 0x10 || (mos6502::i16)(last.pc + 2 + (int8_t)last.operand) != block.pc){
+            return false;
+        }
+        for(int i = 0; i < block.count - 1; i++){
+            if(!cpu::CPU::isPollSafe(block.ins[i].op, block.ins[i].operand, *this->bus)){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Cache::codeWritten(void *context, const mos6502::i8 *page){
+        Cache *cache = (Cache *)context;
+        for(size_t i = 0; i < cache->blocks.size(); i++){
+            Block &block = cache->blocks[i];
+            if(block.host == page && block.count){
+                block.count = 0;
+                cache->stats.invalidations++;
+            }
+        }
+        cache->bus->unwatchCode(page);
+    }
+
+    // THE CURRENT WALK MAY BE RUNNING FROM A PAGE THAT WAS JUST SWITCHED OUT.
+    // BLOCKS THEMSELVES STAY, THEIR KEY STILL NAMES THE OLD BANK.
+    void Cache::remapped(void *context){
+        Cache *cache = (Cache *)context;
+        cache->current = &empty;
+        cache->index = 0;
+    }
+
+    void Cache::flush(){
+        for(size_t i = 0; i < this->blocks.size(); i++){
+            if(this->blocks[i].count && this->blocks[i].writable){
+                this->bus->unwatchCode(this->blocks[i].host);
+            }
+            this->blocks[i].host   = NULL;
+            this->blocks[i].native = NULL;
+            this->blocks[i].count  = 0;
+        }
+        this->current = &empty;
+        this->index = 0;
+        this->writableCode = false;
+    }
+
+    void Cache::flushWritable(){
+        if(!this->writableCode){
+            return;
+        }
+        for(size_t i = 0; i < this->blocks.size(); i++){
+            if(this->blocks[i].count && this->blocks[i].writable){
+                this->bus->unwatchCode(this->blocks[i].host);
+                this->blocks[i].native = NULL;
+                this->blocks[i].count  = 0;
+            }
+        }
+        this->current = &empty;
+        this->index = 0;
+        this->writableCode = false;
+    }
+
+    void Cache::dropNative(){
+        for(size_t i = 0; i < this->blocks.size(); i++){
+            this->blocks[i].native = NULL;
+            this->blocks[i].heat   = 0;
+        }
+    }
+
+    void Cache::resetStats(){
+        memset(&this->stats, 0, sizeof(this->stats));
+    }
+
+};
@@ -0,0 +1,145 @@
+#include "../include/BUS.h"
+#include <string.h>
+
+namespace bus{
+
+    Bus::Bus(state::Memory &memory) : memory(&memory){
+        memset(this->prg, 0xFF, sizeof(this->prg));
+        memset(this->watched, 0, sizeof(this->watched));
+        this->codeWriteHandler = NULL;
+        this->codeWriteContext = NULL;
+        this->remapHandler = NULL;
+        this->remapContext = NULL;
+        this->reset();
+
+        this->mapHandler(0x0000, 0xFFFF, &Bus::readOpenBus, &Bus::writeIgnored, this);
+
+        this->mapMemory(0x0000, 0x1FFF, memory.ram, sizeof(memory.ram), true);
+        this->mapHandler(0x2000, 0x3FFF, &Bus::readPPULatch, &Bus::writePPULatch, this);
+        this->mapHandler(0x4000, 0x40FF, &Bus::readIOLatch, &Bus::writeIOLatch, this);
+        this->mapMemory(0x6000, 0x7FFF, memory.sram, sizeof(memory.sram), true);
+        this->mapPRG();
+    }
+
+    void Bus::mapPRG(){
+        this->mapHandler(0x8000, 0xFFFF, NULL, &Bus::writeIgnored, this);
+        this->mapMemory(0x8000, 0xFFFF, this->prg, sizeof(this->prg), false);
+    }
+
+    void Bus::mapMemory(mos6502::i16 start, mos6502::i16 end, mos6502::i8 *memory, mos6502::i16 size, bool writable){
+        mos6502::i16 pages = size >> 8;
+        for(int page = start >> 8; page <= end >> 8; page++){
+            mos6502::i8 *target = memory + (((page - (start >> 8)) % pages) << 8);
+            this->readPages[page]  = target;
+            this->writePages[page] = writable ? target : NULL;
+            this->watched[page]    = NULL;
+            if(writable && this->isWatched(target)){
+                this->writePages[page] = NULL;
+                this->watched[page]    = target;
+            }
+        }
+        if(this->remapHandler){
+            this->remapHandler(this->remapContext);
+        }
+    }
+
+    bool Bus::isWatched(const mos6502::i8 *page){
+        for(int i = 0; i < 256; i++){
+            if(this->watched[i] == page){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Bus::watchCode(const mos6502::i8 *page){
+        for(int i = 0; i < 256; i++){
+            if(this->writePages[i] == page){
+                this->watched[i]    = this->writePages[i];
+                this->writePages[i] = NULL;
+            }
+        }
+    }
+
+    void Bus::unwatchCode(const mos6502::i8 *page){
+        for(int i = 0; i < 256; i++){
+            if(this->watched[i] == page){
+                this->writePages[i] = this->watched[i];
+                this->watched[i]    = NULL;
+            }
+        }
+    }
+
+    void Bus::setCodeWriteHandler(CodeWriteHandler handler, void *context){
+        this->codeWriteHandler = handler;
+        this->codeWriteContext = context;
+    }
+
+    void Bus::setRemapHandler(RemapHandler handler, void *context){
+        this->remapHandler = handler;
+        this->remapContext = context;
+    }
+
+    void Bus::mapHandler(mos6502::i16 start, mos6502::i16 end, ReadHandler read, WriteHandler write, void *context){
+        for(int page = start >> 8; page <= end >> 8; page++){
+            if(read){
+                this->readPages[page] = NULL;
+                this->regions[page].read = read;
+                this->regions[page].readContext = context;
+            }
+            if(write){
+                this->writePages[page] = NULL;
+                this->watched[page]    = NULL;
+                this->regions[page].write = write;
+                this->regions[page].writeContext = context;
+            }
+        }
+        if(this->remapHandler){
+            this->remapHandler(this->remapContext);
+        }
+    }
+
+    void Bus::reset(){
+        // STACK AND ZERO PAGE START CLEARED, GENERAL PURPOSE RAM STARTS AT 0XFF.
+        state::Memory &memory = *this->memory;
+        memset(memory.ram, 0, 0x200);
+        memset(memory.ram + 0x200, 0xFF, sizeof(memory.ram) - 0x200);
+        memset(memory.sram, 0, sizeof(memory.sram));
+        memset(memory.ppuLatch, 0, sizeof(memory.ppuLatch));
+        memset(memory.ioLatch, 0, sizeof(memory.ioLatch));
+    }
+
+    mos6502::i8 Bus::readPPULatch(void *context, mos6502::i16 addr){
+        return ((Bus *)context)->memory->ppuLatch[addr & 0x7];
+    }
+
+    void Bus::writePPULatch(void *context, mos6502::i16 addr, mos6502::i8 data){
+        ((Bus *)context)->memory->ppuLatch[addr & 0x7] = data;
+    }
+
+    mos6502::i8 Bus::readIOLatch(void *context, mos6502::i16 addr){
+        if(addr >= 0x4020){
+            return readOpenBus(context, addr);
+        }
+        return ((Bus *)context)->memory->ioLatch[addr & 0x1F];
+    }
+
+    void Bus::writeIOLatch(void *context, mos6502::i16 addr, mos6502::i8 data){
+        if(addr < 0x4020){
+            ((Bus *)context)->memory->ioLatch[addr & 0x1F] = data;
+        }
+    }
+
+    mos6502::i8 Bus::readOpenBus(void *context, mos6502::i16 addr){
+        // THE DATA BUS USUALLY STILL HOLDS THE HIGH BYTE OF THE ADDRESS.
+        return addr >> 8;
+    }
+
+    void Bus::writeIgnored(void *context, mos6502::i16 addr, mos6502::i8 data){
+    }
+
+    Bus::~Bus(){
+
+    }
+
+};
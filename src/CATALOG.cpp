@@ -0,0 +1,327 @@
+#include "../include/CATALOG.h"
+#include "../include/ROM.h"
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace catalog{
+
+    static_assert(sizeof(FileHeader) == 64, "FileHeader is part of the file format");
+    static_assert(sizeof(Entry) == 64, "Entry is part of the file format");
+
+    // ONE ROM FILE FOUND BY THE SCAN.
+    struct Found{
+        std::string path;           // RELATIVE TO THE ROOT
+        uint64_t size;
+        int64_t mtime;
+        Entry entry;
+        bool indexed;
+    };
+
+    static bool hasSuffix(const char *name, const char *suffix){
+        size_t length = strlen(name), n = strlen(suffix);
+        return length > n && strcasecmp(name + length - n, suffix) == 0;
+    }
+
+    // WHAT rom::ROM::loadNesFile() TAKES.
+    static bool isRom(const char *name){
+        return hasSuffix(name, ".nes") || hasSuffix(name, ".nes.gz") || hasSuffix(name, ".zip");
+    }
+
+    // DEPTH FIRST, IN readdir() ORDER; THE INDEX SORTS EVERYTHING ANYWAY.
+    // SYMLINKED ROMS ARE INDEXED, SYMLINKED DIRECTORIES ARE NOT ENTERED, SO A
+    // LINK BACK UP THE TREE CANNOT LOOP.
+    static bool scan(const std::string &root, const std::string &relative, std::vector<Found> &found){
+        std::string path = relative.empty() ? root : root + "/" + relative;
+        DIR *dir = opendir(path.c_str());
+        if(dir == NULL){
+            return false;
+        }
+        struct dirent *item;
+        while((item = readdir(dir)) != NULL){
+            if(item->d_name[0] == '.'){
+                continue;
+            }
+            std::string child = relative.empty() ? item->d_name : relative + "/" + item->d_name;
+            std::string full = root + "/" + child;
+            struct stat info;
+            if(lstat(full.c_str(), &info) != 0){
+                continue;
+            }
+            if(S_ISLNK(info.st_mode) && (stat(full.c_str(), &info) != 0 || S_ISDIR(info.st_mode))){
+                continue;
+            }
+            if(S_ISDIR(info.st_mode)){
+                scan(root, child, found);
+            }else if(S_ISREG(info.st_mode) && isRom(item->d_name)){
+                Found file;
+                file.path    = child;
+                file.size    = info.st_size;
+                file.mtime   = info.st_mtime;
+                file.indexed = false;
+                memset(&file.entry, 0, sizeof(file.entry));
+                found.push_back(file);
+            }
+        }
+        closedir(dir);
+        return true;
+    }
+
+    static bool indexRom(const std::string &file, Entry &entry){
+        rom::ROM rom;
+        rom.setVerbose(false);
+        if(rom.loadNesFile(file.c_str()) != 0){
+            return false;
+        }
+        memset(&entry, 0, sizeof(entry));
+        entry.crc32 = rom.getCRC32();
+        rom.getSHA1(entry.sha1);
+        entry.mapper    = rom.getMapperType();
+        entry.prgBanks  = rom.getPRGBanks();
+        entry.chrBanks  = rom.getCHRBanks();
+        entry.mirroring = rom.getMirroring();
+        entry.flags     = (rom.hasBatteryRam() ? BATTERY : 0) | (rom.hasTrainer() ? TRAINER : 0)
+                        | (rom.hasFourScreen() ? FOUR_SCREEN : 0) | (rom.isNES2() ? NES2 : 0);
+        entry.tv        = rom.getTVSystem();
+        memcpy(entry.header, rom.getHeader() + 6, sizeof(entry.header));
+        return true;
+    }
+
+    static bool bySHA1Less(const Entry &a, const Entry &b){
+        return memcmp(a.sha1, b.sha1, sizeof(a.sha1)) < 0;
+    }
+
+    long build(const char *dir, const char *indexPath, int threads, std::ostream *log){
+        std::string root(dir);
+        while(root.size() > 1 && root[root.size() - 1] == '/'){
+            root.erase(root.size() - 1);
+        }
+        std::vector<Found> found;
+        if(!scan(root, "", found)){
+            if(log){
+                *log<<"directory '"<<dir<<"' open filed"<<std::endl;
+            }
+            return -1;
+        }
+
+        // WHAT THE LAST INDEX OF THE SAME ROOT ALREADY KNOWS.
+        long reused = 0;
+        Index previous;
+        if(previous.open(indexPath) == 0 && root == previous.getRoot()){
+            for(size_t i = 0; i < found.size(); i++){
+                const Entry *old = previous.findPath(found[i].path.c_str());
+                if(old && old->size == found[i].size && old->mtime == found[i].mtime){
+                    found[i].entry   = *old;
+                    found[i].indexed = true;
+                    reused++;
+                }
+            }
+        }
+        previous.close();
+
+        // THE REST ON threads WORKERS, EACH TAKING THE NEXT FILE.
+        if(threads <= 0){
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        std::atomic<size_t> next(0);
+        std::vector<char> bad(found.size(), 0);
+        std::vector<std::thread> workers;
+        for(int t = 0; t < threads; t++){
+            workers.push_back(std::thread([&](){
+                for(size_t i = next++; i < found.size(); i = next++){
+                    if(!found[i].indexed){
+                        bad[i] = !indexRom(root + "/" + found[i].path, found[i].entry);
+                    }
+                }
+            }));
+        }
+        for(size_t t = 0; t < workers.size(); t++){
+            workers[t].join();
+        }
+
+        // STRINGS: THE ROOT, THEN EVERY PATH.
+        std::vector<Entry> entries;
+        std::string strings(root.c_str(), root.size() + 1);
+        for(size_t i = 0; i < found.size(); i++){
+            if(bad[i]){
+                if(log){
+                    *log<<found[i].path<<": not an iNES image"<<std::endl;
+                }
+                continue;
+            }
+            Entry entry = found[i].entry;
+            entry.size  = found[i].size;
+            entry.mtime = found[i].mtime;
+            entry.path  = strings.size();
+            strings.append(found[i].path.c_str(), found[i].path.size() + 1);
+            entries.push_back(entry);
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b){
+            return a.crc32 != b.crc32 ? a.crc32 < b.crc32 : bySHA1Less(a, b);
+        });
+        std::vector<uint32_t> byName(entries.size()), bySHA1(entries.size());
+        for(uint32_t i = 0; i < entries.size(); i++){
+            byName[i] = bySHA1[i] = i;
+        }
+        const char *text = strings.c_str();
+        std::sort(byName.begin(), byName.end(), [&](uint32_t a, uint32_t b){
+            return strcmp(text + entries[a].path, text + entries[b].path) < 0;
+        });
+        std::sort(bySHA1.begin(), bySHA1.end(), [&](uint32_t a, uint32_t b){
+            return bySHA1Less(entries[a], entries[b]);
+        });
+
+        FileHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic       = MAGIC;
+        header.version     = VERSION;
+        header.count       = entries.size();
+        header.entrySize   = sizeof(Entry);
+        header.strings     = sizeof(FileHeader) + entries.size() * (sizeof(Entry) + 2 * sizeof(uint32_t));
+        header.stringsSize = strings.size();
+
+        // WRITE NEXT TO IT AND RENAME, SO A READER SEES THE OLD INDEX OR THE NEW.
+        std::string temporary = std::string(indexPath) + ".tmp";
+        {
+            std::ofstream out(temporary.c_str(), std::ios::binary | std::ios::trunc);
+            if(!out){
+                if(log){
+                    *log<<"file '"<<temporary<<"' open filed"<<std::endl;
+                }
+                return -1;
+            }
+            out.write((const char *)&header, sizeof(header));
+            if(!entries.empty()){
+                out.write((const char *)&entries[0], entries.size() * sizeof(Entry));
+                out.write((const char *)&byName[0], byName.size() * sizeof(uint32_t));
+                out.write((const char *)&bySHA1[0], bySHA1.size() * sizeof(uint32_t));
+            }
+            out.write(strings.data(), strings.size());
+            if(!out){
+                return -1;
+            }
+        }
+        if(rename(temporary.c_str(), indexPath) != 0){
+            return -1;
+        }
+        if(log){
+            *log<<entries.size()<<" roms indexed ("<<reused<<" unchanged), "
+                <<(found.size() - entries.size())<<" skipped"<<std::endl;
+        }
+        return entries.size();
+    }
+
+
+    Index::Index(){
+        this->base    = NULL;
+        this->size    = 0;
+        this->header  = NULL;
+        this->entries = NULL;
+        this->byName  = NULL;
+        this->bySHA1  = NULL;
+        this->strings = NULL;
+    }
+
+    Index::~Index(){
+        this->close();
+    }
+
+    int Index::open(const char *path){
+        this->close();
+        int fd = ::open(path, O_RDONLY);
+        if(fd < 0){
+            return -1;
+        }
+        struct stat info;
+        void *mapped = MAP_FAILED;
+        if(fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(FileHeader)){
+            mapped = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if(mapped == MAP_FAILED){
+            return -1;
+        }
+        this->base = (const mos6502::i8 *)mapped;
+        this->size = info.st_size;
+
+        // EVERYTHING THE HEADER POINTS AT HAS TO BE INSIDE THE FILE.
+        const FileHeader *header = (const FileHeader *)this->base;
+        uint64_t tables = sizeof(FileHeader) + (uint64_t)header->count * (sizeof(Entry) + 2 * sizeof(uint32_t));
+        if(header->magic != MAGIC || header->version != VERSION || header->entrySize != sizeof(Entry)
+           || header->strings != tables || header->stringsSize == 0 || header->stringsSize > this->size
+           || header->strings + header->stringsSize > this->size
+           || this->base[header->strings + header->stringsSize - 1] != 0){
+            this->close();
+            return -1;
+        }
+        const Entry *entries  = (const Entry *)(this->base + sizeof(FileHeader));
+        const uint32_t *byName = (const uint32_t *)(entries + header->count);
+        const uint32_t *bySHA1 = byName + header->count;
+
+        // AND SO DOES EVERYTHING THE TABLES POINT AT. THE STRING TABLE ENDS IN A
+        // NUL, SO A PATH THAT STARTS INSIDE IT ENDS INSIDE IT.
+        for(uint32_t i = 0; i < header->count; i++){
+            if(byName[i] >= header->count || bySHA1[i] >= header->count || entries[i].path >= header->stringsSize){
+                this->close();
+                return -1;
+            }
+        }
+        this->header  = header;
+        this->entries = entries;
+        this->byName  = byName;
+        this->bySHA1  = bySHA1;
+        this->strings = (const char *)(this->base + header->strings);
+        return 0;
+    }
+
+    void Index::close(){
+        if(this->base != NULL){
+            munmap((void *)this->base, this->size);
+        }
+        this->base    = NULL;
+        this->size    = 0;
+        this->header  = NULL;
+        this->entries = NULL;
+        this->byName  = NULL;
+        this->bySHA1  = NULL;
+        this->strings = NULL;
+    }
+
+    const Entry *Index::findCRC32(uint32_t crc) const{
+        const Entry *end = this->entries + this->count();
+        const Entry *at = std::lower_bound(this->entries, end, crc, [](const Entry &e, uint32_t crc){
+            return e.crc32 < crc;
+        });
+        return at != end && at->crc32 == crc ? at : NULL;
+    }
+
+    const Entry *Index::findSHA1(const mos6502::i8 sha1[20]) const{
+        const uint32_t *end = this->bySHA1 + this->count();
+        const uint32_t *at = std::lower_bound(this->bySHA1, end, sha1, [this](uint32_t i, const mos6502::i8 *sha1){
+            return memcmp(this->entries[i].sha1, sha1, 20) < 0;
+        });
+        return at != end && memcmp(this->entries[*at].sha1, sha1, 20) == 0 ? &this->entries[*at] : NULL;
+    }
+
+    const Entry *Index::findPath(const char *path) const{
+        const uint32_t *end = this->byName + this->count();
+        const uint32_t *at = std::lower_bound(this->byName, end, path, [this](uint32_t i, const char *path){
+            return strcmp(this->strings + this->entries[i].path, path) < 0;
+        });
+        return at != end && strcmp(this->strings + this->entries[*at].path, path) == 0 ? &this->entries[*at] : NULL;
+    }
+
+    std::string Index::getFullPath(const Entry &entry) const{
+        return std::string(this->getRoot()) + "/" + this->getPath(entry);
+    }
+};
@@ -0,0 +1,140 @@
+#include "../include/CONFORM.h"
+#include <sstream>
+#include <string.h>
+
+namespace conform{
+
+    // CYCLES PER runCycles() CALL: A DIVERGENCE STOPS THE RUN WITHIN THIS MANY.
+    // AT 2 CYCLES OR MORE AN INSTRUCTION, THE TRACE HOLDS A WHOLE CHUNK.
+    static const uint32_t CHUNK = 1024;
+
+    static int digit(char c){
+        if(c >= '0' && c <= '9') return c - '0';
+        if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+        if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    }
+
+    static bool hex(const char *p, int digits, uint32_t &value){
+        value = 0;
+        for(int i = 0; i < digits; i++){
+            int d = digit(p[i]);
+            if(d < 0){
+                return false;
+            }
+            value = (value << 4) | d;
+        }
+        return true;
+    }
+
+    // TWO HEX DIGITS AFTER key, E.G. " A:".
+    static bool byte(const char *text, const char *key, mos6502::i8 &value){
+        const char *at = strstr(text, key);
+        uint32_t parsed;
+        if(at == NULL || !hex(at + strlen(key), 2, parsed)){
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+
+    Reader::Reader(std::istream &in) : in(&in){
+        this->number = 0;
+    }
+
+    bool Reader::parse(const std::string &text, Line &line){
+        const char *s = text.c_str();
+        uint32_t pc;
+        if(!strncmp(s, "PC:", 3)){
+            if(!hex(s + 3, 4, pc)){
+                return false;
+            }
+        }else if(!hex(s, 4, pc) || s[4] != ' '){
+            return false;
+        }
+        line.pc = pc;
+        if(!byte(s, " A:", line.A) || !byte(s, " X:", line.X) || !byte(s, " Y:", line.Y)
+           || !byte(s, " P:", line.P) || !byte(s, " SP:", line.SP)){
+            return false;
+        }
+        const char *cyc = strstr(s, "CYC:");
+        line.hasCycle = cyc != NULL && strstr(s, " SL:") == NULL;
+        line.cycle = line.hasCycle ? strtoull(cyc + 4, NULL, 10) : 0;
+        return true;
+    }
+
+    bool Reader::next(Line &line){
+        while(std::getline(*this->in, line.text)){
+            this->number++;
+            if(!line.text.empty() && line.text[line.text.size() - 1] == '\r'){
+                line.text.erase(line.text.size() - 1);
+            }
+            if(parse(line.text, line)){
+                line.number = this->number;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Checker::Checker(Reader &reader, bool checkCycles) : reader(&reader){
+        this->failed = false;
+        this->matched = 0;
+        this->checkCycles = checkCycles;
+        memset(&this->got, 0, sizeof(this->got));
+        memset(this->recent, 0, sizeof(this->recent));
+        this->ended = !this->reader->next(this->expected);
+    }
+
+    void Checker::report(std::ostream &out) const{
+        if(!this->failed){
+            out<<this->matched<<" instructions matched"<<(this->ended ? ", end of log" : "")<<std::endl;
+            return;
+        }
+        uint64_t first = this->matched > CONTEXT ? this->matched - CONTEXT : 0;
+        for(uint64_t i = first; i < this->matched; i++){
+            out<<"    ";
+            trace::format(this->recent[i % CONTEXT], out);
+        }
+        const Line &e = this->expected;
+        const trace::Record &g = this->got;
+        out<<"diverged after "<<this->matched<<" instructions, at line "<<e.number<<" of the log"<<std::endl;
+        out<<"  expected: "<<e.text<<std::endl;
+        out<<"  got:      ";
+        trace::format(g, out);
+
+        std::ostringstream fields;
+        char value[48];
+        #define FIELD(name, want, have, width)                                                 \
+            if((want) != (have)){                                                               \
+                snprintf(value, sizeof(value), " %s %0*X != %0*X", name, width, (unsigned)(want), \
+                         width, (unsigned)(have));                                               \
+                fields<<value;                                                                  \
+            }
+        FIELD("PC", e.pc, g.pc, 4)
+        FIELD("A",  e.A,  g.A,  2)
+        FIELD("X",  e.X,  g.X,  2)
+        FIELD("Y",  e.Y,  g.Y,  2)
+        FIELD("P",  e.P,  g.P,  2)
+        FIELD("SP", e.SP, g.SP, 2)
+        #undef FIELD
+        if(this->checkCycles && e.hasCycle && e.cycle != g.cycle){
+            fields<<" CYC "<<e.cycle<<" != "<<g.cycle;
+        }
+        out<<"  differs:"<<fields.str()<<std::endl;
+    }
+
+    bool run(cpu::CPU &cpu, Checker &checker, uint64_t limit){
+        trace::BinaryTrace trace(CHUNK);
+        while(!checker.stopped() && (limit == 0 || checker.getMatched() < limit)){
+            trace.clear();
+            cpu.runCycles(CHUNK, trace);
+            for(uint64_t i = 0, n = trace.size(); i < n; i++){
+                if(!checker.check(trace.at(i)) || checker.getMatched() == limit){
+                    break;
+                }
+            }
+        }
+        return !checker.failed;
+    }
+};
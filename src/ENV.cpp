@@ -0,0 +1,264 @@
+#include "../include/ENV.h"
+#include <thread>
+#include <iostream>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace env{
+
+    // A FEW MICROSECONDS OF POLLING BEFORE GOING TO SLEEP: ON ANOTHER CORE A
+    // STEP OF A FEW INSTANCES IS OVER BEFORE A FUTEX WAIT WOULD EVEN RETURN.
+    // ON ONE CORE THE OTHER SIDE CANNOT RUN WHILE WE SPIN, SO DO NOT.
+    static int spins(){
+        static const int count = std::thread::hardware_concurrency() > 1 ? 100 : 0;
+        return count;
+    }
+
+    static inline void pause(){
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    static void wake(std::atomic<uint32_t> &word){
+#ifdef LINUX
+        syscall(SYS_futex, (uint32_t *)&word, FUTEX_WAKE, 0x7FFFFFFF, NULL, NULL, 0);
+#else
+        (void)word;
+#endif
+    }
+
+    // UNTIL word IS NO LONGER old OR THE SERVER STOPS. RETURNS THE NEW VALUE.
+    static uint32_t await(Control *control, std::atomic<uint32_t> &word, uint32_t old){
+        int limit = spins();
+        for(int spin = 0; ; spin++){
+            uint32_t value = word.load(std::memory_order_acquire);
+            if(value != old || control->stop.load(std::memory_order_relaxed)){
+                return value;
+            }
+            if(spin < limit){
+                pause();
+                continue;
+            }
+#ifdef LINUX
+            // RETURNS AT ONCE IF word CHANGED SINCE THE LOAD ABOVE.
+            syscall(SYS_futex, (uint32_t *)&word, FUTEX_WAIT, old, NULL, NULL, 0);
+#else
+            std::this_thread::yield();
+#endif
+        }
+    }
+
+    static std::string path(const char *name){
+        return std::string("/") + name;
+    }
+
+    Server::Server(){
+        this->control = NULL;
+        this->size = 0;
+    }
+
+    int Server::open(const char *name, const char *rom, uint32_t instances, int workers){
+        if(instances == 0){
+            return -1;
+        }
+        if(workers <= 0){
+            workers = std::thread::hardware_concurrency();
+        }
+        if(workers <= 0){
+            workers = 1;
+        }
+        if((uint32_t)workers > instances){
+            workers = instances;
+        }
+
+        for(uint32_t i = 0; i < instances; i++){
+            std::unique_ptr<nes::NES> machine(new nes::NES());
+            if(machine->loadRom(rom) != 0){
+                return -1;
+            }
+            this->machines.push_back(std::move(machine));
+        }
+
+        this->name = path(name);
+        size_t slotSize = (sizeof(Slot) + PAGE - 1) / PAGE * PAGE;
+        size_t size = PAGE + instances * slotSize;
+        shm_unlink(this->name.c_str());
+        int fd = shm_open(this->name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if(fd < 0){
+            std::cout<<"shared memory '"<<this->name<<"' open filed"<<std::endl;
+            return -1;
+        }
+        void *memory = MAP_FAILED;
+        if(ftruncate(fd, size) == 0){
+            memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if(memory == MAP_FAILED){
+            shm_unlink(this->name.c_str());
+            return -1;
+        }
+        this->control = (Control *)memory;
+        this->size = size;
+
+        // FRESH PAGES ARE ZERO; FILL IN THE GEOMETRY AND THE FIRST OBSERVATIONS.
+        this->control->version   = VERSION;
+        this->control->instances = instances;
+        this->control->slotSize  = slotSize;
+        this->control->width     = nes::NES::WIDTH;
+        this->control->height    = nes::NES::HEIGHT;
+        this->control->ramSize   = sizeof(((Slot *)0)->ram);
+        this->control->workers   = workers;
+        this->control->pending.store(workers, std::memory_order_relaxed);
+        for(uint32_t i = 0; i < instances; i++){
+            this->getSlot(i)->frameVersion = ~0u;
+            this->publish(i);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        this->control->magic = MAGIC;
+        return 0;
+    }
+
+    void Server::publish(size_t i){
+        Slot *slot = this->getSlot(i);
+        nes::NES &machine = *this->machines[i];
+        memcpy(slot->ram, machine.ram(), sizeof(slot->ram));
+        uint32_t version = machine.getPPU()->getVersion();
+        if(slot->frameVersion != version){
+            memcpy(slot->framebuffer, machine.framebuffer(), sizeof(slot->framebuffer));
+            slot->frameVersion = version;
+        }
+    }
+
+    // WORKER w STEPS INSTANCES w, w + workers, ... OF EVERY REQUEST. THE LAST
+    // ONE DONE RE-ARMS pending AND ANSWERS; THE CLIENT CANNOT SEND THE NEXT
+    // REQUEST BEFORE THAT, SO pending IS NEVER RE-ARMED EARLY. A WORKER STARTS
+    // FROM THE LAST ANSWERED REQUEST, NOT THE LAST SENT ONE: A CLIENT MAY STEP
+    // BEFORE EVERY THREAD IS UP, AND THAT REQUEST IS STILL OWED.
+    void Server::work(int worker){
+        Control *control = this->control;
+        uint32_t workers = control->workers;
+        uint32_t seen = control->response.load(std::memory_order_acquire);
+        for(;;){
+            uint32_t request = await(control, control->request, seen);
+            if(control->stop.load(std::memory_order_relaxed)){
+                return;
+            }
+            seen = request;
+            for(size_t i = worker; i < this->machines.size(); i += workers){
+                Slot *slot = this->getSlot(i);
+                nes::NES &machine = *this->machines[i];
+                if(slot->reset){
+                    machine.reset();
+                    slot->reset = 0;
+                    slot->frame = 0;
+                    slot->cycles = 0;
+                }
+                machine.setInput(0, slot->input[0]);
+                machine.setInput(1, slot->input[1]);
+                slot->cycles += machine.stepFrame();
+                slot->frame++;
+                this->publish(i);
+            }
+            if(control->pending.fetch_sub(1, std::memory_order_acq_rel) == 1){
+                control->pending.store(workers, std::memory_order_relaxed);
+                control->response.store(request, std::memory_order_release);
+                wake(control->response);
+            }
+        }
+    }
+
+    uint64_t Server::run(){
+        uint32_t first = this->control->response.load(std::memory_order_relaxed);
+        std::vector<std::thread> threads;
+        for(uint32_t i = 1; i < this->control->workers; i++){
+            threads.push_back(std::thread(&Server::work, this, (int)i));
+        }
+        this->work(0);
+        for(size_t i = 0; i < threads.size(); i++){
+            threads[i].join();
+        }
+        return this->control->response.load(std::memory_order_relaxed) - first;
+    }
+
+    void Server::stop(){
+        if(this->control == NULL){
+            return;
+        }
+        this->control->stop.store(1, std::memory_order_release);
+        wake(this->control->request);
+        wake(this->control->response);
+    }
+
+    Server::~Server(){
+        if(this->control != NULL){
+            this->stop();
+            munmap(this->control, this->size);
+            shm_unlink(this->name.c_str());
+        }
+    }
+
+    Client::Client(){
+        this->control = NULL;
+        this->size = 0;
+    }
+
+    int Client::open(const char *name){
+        int fd = shm_open(path(name).c_str(), O_RDWR, 0);
+        if(fd < 0){
+            return -1;
+        }
+        struct stat info;
+        void *memory = MAP_FAILED;
+        if(fstat(fd, &info) == 0 && (size_t)info.st_size >= PAGE){
+            memory = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if(memory == MAP_FAILED){
+            return -1;
+        }
+        Control *control = (Control *)memory;
+        uint32_t magic = *(volatile uint32_t *)&control->magic;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(magic != MAGIC || control->version != VERSION || control->stop.load()
+           || PAGE + (size_t)control->instances * control->slotSize > (size_t)info.st_size){
+            munmap(memory, info.st_size);
+            return -1;
+        }
+        this->control = control;
+        this->size = info.st_size;
+        return 0;
+    }
+
+    int Client::step(){
+        uint32_t request = this->control->request.load(std::memory_order_relaxed) + 1;
+        this->control->request.store(request, std::memory_order_release);
+        wake(this->control->request);
+        uint32_t response = this->control->response.load(std::memory_order_acquire);
+        while(response != request){
+            if(this->control->stop.load(std::memory_order_relaxed)){
+                return -1;
+            }
+            response = await(this->control, this->control->response, response);
+        }
+        return 0;
+    }
+
+    void Client::shutdown(){
+        this->control->stop.store(1, std::memory_order_release);
+        wake(this->control->request);
+    }
+
+    Client::~Client(){
+        if(this->control != NULL){
+            munmap(this->control, this->size);
+        }
+    }
+};
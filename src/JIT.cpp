@@ -0,0 +1,287 @@
+#include "../include/JIT.h"
+#include "../include/CPU.h"
+#include <string.h>
+
+#ifdef HAVE_JIT
+#include <sys/mman.h>
+#endif
+
+namespace jit{
+
+    Compiler::Compiler(){
+        this->arena  = NULL;
+        this->used   = 0;
+        this->failed = false;
+        memset(&this->stats, 0, sizeof(this->stats));
+    }
+
+#ifdef HAVE_JIT
+
+    /**
+     * MINIMAL X86-64 EMITTER. THE CPU POINTER LIVES IN RBX FOR THE WHOLE BLOCK,
+     * EVERY FIELD IS ADDRESSED AS [RBX + DISP32]. RAX/RCX/RDI ARE SCRATCH.
+     */
+    class Emitter{
+
+        private:
+
+            mos6502::i8 *code;
+
+        public:
+
+            Emitter(mos6502::i8 *code) : code(code){}
+
+            mos6502::i8 *here(){return this->code;}
+
+            void byte(mos6502::i8 b){*this->code++ = b;}
+            void word(uint16_t w){memcpy(this->code, &w, 2); this->code += 2;}
+            void dword(uint32_t d){memcpy(this->code, &d, 4); this->code += 4;}
+            void qword(uint64_t q){memcpy(this->code, &q, 8); this->code += 8;}
+
+            // [RBX + disp32] WITH REG FIELD reg
+            void modrm(int reg, uint32_t disp){this->byte(0x83 | (reg << 3)); this->dword(disp);}
+
+            void prologue(){
+                this->byte(0x53);                                           // PUSH RBX
+                this->byte(0x48); this->byte(0x89); this->byte(0xFB);       // MOV RBX, RDI
+            }
+            void epilogue(){
+                this->byte(0x5B);                                           // POP RBX
+                this->byte(0xC3);                                           // RET
+            }
+
+            void store8(uint32_t disp, mos6502::i8 imm){                   // MOV BYTE [RBX+d], imm
+                this->byte(0xC6); this->modrm(0, disp); this->byte(imm);
+            }
+            void store16(uint32_t disp, uint16_t imm){                     // MOV WORD [RBX+d], imm
+                this->byte(0x66); this->byte(0xC7); this->modrm(0, disp); this->word(imm);
+            }
+            void add64(uint32_t disp, uint32_t imm){                       // ADD QWORD [RBX+d], imm
+                this->byte(0x48); this->byte(0x81); this->modrm(0, disp); this->dword(imm);
+            }
+            void loadAL(uint32_t disp){                                    // MOV AL, [RBX+d]
+                this->byte(0x8A); this->modrm(0, disp);
+            }
+            void storeAL(uint32_t disp){                                   // MOV [RBX+d], AL
+                this->byte(0x88); this->modrm(0, disp);
+            }
+            void incAL(){this->byte(0xFE); this->byte(0xC0);}
+            void decAL(){this->byte(0xFE); this->byte(0xC8);}
+            void movRAX(uint64_t imm){                                     // MOV RAX, imm64
+                this->byte(0x48); this->byte(0xB8); this->qword(imm);
+            }
+            void storeRAX(uint32_t disp){                                  // MOV [RBX+d], RAX
+                this->byte(0x48); this->byte(0x89); this->modrm(0, disp);
+            }
+            void loadALFromRAX(){                                          // MOV AL, [RAX]
+                this->byte(0x8A); this->byte(0x00);
+            }
+            void callThunk(uint64_t target){
+                this->byte(0x48); this->byte(0x89); this->byte(0xDF);       // MOV RDI, RBX
+                this->movRAX(target);
+                this->byte(0xFF); this->byte(0xD0);                         // CALL RAX
+            }
+    };
+
+    bool Compiler::available(){
+        return !this->failed;
+    }
+
+    // CAN THIS INSTRUCTION WRITE SOMEWHERE OTHER THAN PLAIN MEMORY?
+    bool Compiler::mayRemap(cpu::CPU &cpu, mos6502::i8 op, mos6502::i16 operand){
+        typedef cpu::CPU C;
+        const C::OpINS &ins = C::opTable[op];
+        C::opHandler h = ins.opHandler;
+        bool stores = h == &C::STA || h == &C::STX || h == &C::STY || h == &C::SAX
+                   || h == &C::SHY || h == &C::SHX || h == &C::AHX || h == &C::TAS
+                   || h == &C::ASL || h == &C::LSR || h == &C::ROL || h == &C::ROR
+                   || h == &C::INC || h == &C::DEC || h == &C::SLO || h == &C::RLA
+                   || h == &C::SRE || h == &C::RRA || h == &C::DCP || h == &C::ISC;
+        if(!stores){
+            return false;
+        }
+        switch(ins.addrMode){
+            case C::ACCEUMULATOR:
+            case C::ZEROPAGE:
+            case C::ZEROPAGEX:
+            case C::ZEROPAGEY:
+                return false;
+            case C::ABSOLUTE:
+                return !cpu.bus.isWritable(operand);
+        }
+        return true;
+    }
+
+    // W^X: THE ARENA IS EITHER RW OR RX. A REFUSED FLIP DISABLES THE COMPILER.
+    bool Compiler::setWritable(bool writable){
+        if(mprotect(this->arena, ARENA_SIZE, writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC) != 0){
+            this->failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool Compiler::compile(block::Block &block, cpu::CPU &cpu){
+        if(this->failed){
+            return false;
+        }
+        if(!this->arena){
+            void *mem = mmap(NULL, ARENA_SIZE, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(mem == MAP_FAILED){
+                this->failed = true;
+                return false;
+            }
+            this->arena = (mos6502::i8 *)mem;
+        }
+        if(this->full()){
+            return false;
+        }
+
+        #define FIELD(name) (uint32_t)((char *)&cpu.name - (char *)&cpu)
+        const uint32_t PC = FIELD(PC), A = FIELD(A), X = FIELD(X), Y = FIELD(Y);
+        const uint32_t N = FIELD(flagN), Z = FIELD(flagZ), CARRY = FIELD(flagC);
+        const uint32_t CYCLES = FIELD(cycles), OPINS = FIELD(opINS);
+        const uint32_t OPERAND = FIELD(operand), OPPC = FIELD(opPC);
+        #undef FIELD
+
+        // HOW MUCH OF THE BLOCK CAN RUN WITHOUT THE INTERPRETER LOOKING.
+        int count = 0;
+        uint32_t cycles = 0, worst = 0;
+        while(count < block.count){
+            const block::Instruction &ins = block.ins[count];
+            const cpu::CPU::OpINS &desc = cpu::CPU::opTable[ins.op];
+            if(desc.opHandler == &cpu::CPU::KIL){
+                break;
+            }
+            cycles += desc.cycles;
+            worst  += desc.cycles + desc.pageCross + (((ins.op & 0x1F) == 0x10) ? 2 : 0);  // TAKEN BRANCH, NEW PAGE
+            count++;
+            if(mayRemap(cpu, ins.op, ins.operand)){
+                break;
+            }
+        }
+        if(!count){
+            this->stats.rejected++;
+            return false;
+        }
+
+        const mos6502::i8 *zeroPage = cpu.bus.readPage(0x0000);
+
+        if(!this->setWritable(true)){
+            return false;
+        }
+        Emitter out(this->arena + this->used);
+        mos6502::i8 *entry = out.here();
+        out.prologue();
+        out.add64(CYCLES, cycles);
+
+        bool pcStale = false;       // PC NOT YET STORED AFTER INLINE CODE
+        for(int i = 0; i < count; i++){
+            const block::Instruction &ins = block.ins[i];
+            const cpu::CPU::OpINS &desc = cpu::CPU::opTable[ins.op];
+            mos6502::i16 next = ins.pc + desc.bytes;
+            mos6502::i8 imm = ins.operand & 0xFF;
+
+            switch(ins.op){
+                case 0xA9: out.store8(A, imm); out.store8(N, imm); out.store8(Z, imm); pcStale = true; continue;   // LDA #
+                case 0xA2: out.store8(X, imm); out.store8(N, imm); out.store8(Z, imm); pcStale = true; continue;   // LDX #
+                case 0xA0: out.store8(Y, imm); out.store8(N, imm); out.store8(Z, imm); pcStale = true; continue;   // LDY #
+                case 0x18: out.store16(CARRY, 0x000); pcStale = true; continue;                                     // CLC
+                case 0x38: out.store16(CARRY, 0x100); pcStale = true; continue;                                     // SEC
+                case 0xEA: pcStale = true; continue;                                                               // NOP
+            }
+
+            uint32_t from = 0, to = 0;
+            int delta = 0;
+            bool transfer = false, zpLoad = false;
+            switch(ins.op){
+                case 0xAA: from = A; to = X; transfer = true; break;            // TAX
+                case 0xA8: from = A; to = Y; transfer = true; break;            // TAY
+                case 0x8A: from = X; to = A; transfer = true; break;            // TXA
+                case 0x98: from = Y; to = A; transfer = true; break;            // TYA
+                case 0xE8: from = to = X; delta =  1; transfer = true; break;   // INX
+                case 0xCA: from = to = X; delta = -1; transfer = true; break;   // DEX
+                case 0xC8: from = to = Y; delta =  1; transfer = true; break;   // INY
+                case 0x88: from = to = Y; delta = -1; transfer = true; break;   // DEY
+                case 0xA5: to = A; zpLoad = true; break;                        // LDA ZP
+                case 0xA6: to = X; zpLoad = true; break;                        // LDX ZP
+                case 0xA4: to = Y; zpLoad = true; break;                        // LDY ZP
+            }
+            if(zpLoad && zeroPage){
+                out.movRAX((uint64_t)(uintptr_t)(zeroPage + imm));
+                out.loadALFromRAX();
+            }else if(transfer){
+                out.loadAL(from);
+                if(delta > 0){
+                    out.incAL();
+                }else if(delta < 0){
+                    out.decAL();
+                }
+            }else{
+                // EVERYTHING ELSE GOES THROUGH THE HANDLER, SET UP LIKE decode() + fetch().
+                out.store16(PC, next);
+                out.store16(OPPC, ins.pc);
+                out.store16(OPERAND, ins.operand);
+                out.movRAX((uint64_t)(uintptr_t)&desc);
+                out.storeRAX(OPINS);
+                out.callThunk((uint64_t)(uintptr_t)cpu::CPU::thunks[ins.op]);
+                pcStale = false;
+                continue;
+            }
+            out.storeAL(to);
+            out.storeAL(N);
+            out.storeAL(Z);
+            pcStale = true;
+        }
+        if(pcStale){
+            const block::Instruction &last = block.ins[count - 1];
+            out.store16(PC, last.pc + cpu::CPU::opTable[last.op].bytes);
+        }
+        out.epilogue();
+        if(!this->setWritable(false)){
+            return false;
+        }
+
+        size_t size = out.here() - entry;
+        this->used += size;
+        this->stats.bytes = this->used;
+        this->stats.compiled++;
+
+        block.native      = (block::NativeBlock)(void *)entry;
+        block.nativeCount  = count;
+        block.nativeCycles = worst;
+        return true;
+    }
+
+    void Compiler::recycle(){
+        this->used = 0;
+        this->stats.bytes = 0;
+        this->stats.recycles++;
+    }
+
+    Compiler::~Compiler(){
+        if(this->arena){
+            munmap(this->arena, ARENA_SIZE);
+        }
+    }
+
+#else
+
+    bool Compiler::available(){
+        return false;
+    }
+
+    bool Compiler::compile(block::Block &block, cpu::CPU &cpu){
+        return false;
+    }
+
+    void Compiler::recycle(){
+    }
+
+    Compiler::~Compiler(){
+    }
+
+#endif
+
+};
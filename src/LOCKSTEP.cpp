@@ -0,0 +1,894 @@
+#include "../include/LOCKSTEP.h"
+#include "../include/OPCODES.h"
+#include <string.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#endif
+
+namespace lockstep{
+
+    /**
+     * BYTE VECTORS OF VEC LANES. ONE 256 BIT REGISTER WITH AVX2, TWO 128 BIT
+     * ONES WITH SSE2 (ALWAYS THERE ON X86-64), PLAIN BYTES ELSEWHERE. A MASK IS
+     * 0XFF IN THE LANES IT SELECTS AND 0X00 IN THE OTHERS.
+     */
+#if defined(__AVX2__)
+    typedef __m256i Reg;
+    #define R_LOAD(p)       _mm256_loadu_si256((const __m256i *)(p))
+    #define R_STORE(p, a)   _mm256_storeu_si256((__m256i *)(p), a)
+    #define R_SET1(x)       _mm256_set1_epi8((char)(x))
+    #define R_AND(a, b)     _mm256_and_si256(a, b)
+    #define R_OR(a, b)      _mm256_or_si256(a, b)
+    #define R_XOR(a, b)     _mm256_xor_si256(a, b)
+    #define R_ANDNOT(a, b)  _mm256_andnot_si256(a, b)
+    #define R_ADD(a, b)     _mm256_add_epi8(a, b)
+    #define R_SUB(a, b)     _mm256_sub_epi8(a, b)
+    #define R_EQ(a, b)      _mm256_cmpeq_epi8(a, b)
+    #define R_MAXU(a, b)    _mm256_max_epu8(a, b)
+    #define R_ANY(a)        (_mm256_movemask_epi8(a) != 0)
+#elif defined(__SSE2__) || defined(_M_X64)
+    typedef __m128i Reg;
+    #define R_LOAD(p)       _mm_loadu_si128((const __m128i *)(p))
+    #define R_STORE(p, a)   _mm_storeu_si128((__m128i *)(p), a)
+    #define R_SET1(x)       _mm_set1_epi8((char)(x))
+    #define R_AND(a, b)     _mm_and_si128(a, b)
+    #define R_OR(a, b)      _mm_or_si128(a, b)
+    #define R_XOR(a, b)     _mm_xor_si128(a, b)
+    #define R_ANDNOT(a, b)  _mm_andnot_si128(a, b)
+    #define R_ADD(a, b)     _mm_add_epi8(a, b)
+    #define R_SUB(a, b)     _mm_sub_epi8(a, b)
+    #define R_EQ(a, b)      _mm_cmpeq_epi8(a, b)
+    #define R_MAXU(a, b)    _mm_max_epu8(a, b)
+    #define R_ANY(a)        (_mm_movemask_epi8(a) != 0)
+#else
+    typedef mos6502::i8 Reg;
+    #define R_LOAD(p)       (*(p))
+    #define R_STORE(p, a)   (*(p) = (a))
+    #define R_SET1(x)       ((mos6502::i8)(x))
+    #define R_AND(a, b)     ((mos6502::i8)((a) & (b)))
+    #define R_OR(a, b)      ((mos6502::i8)((a) | (b)))
+    #define R_XOR(a, b)     ((mos6502::i8)((a) ^ (b)))
+    #define R_ANDNOT(a, b)  ((mos6502::i8)(~(a) & (b)))
+    #define R_ADD(a, b)     ((mos6502::i8)((a) + (b)))
+    #define R_SUB(a, b)     ((mos6502::i8)((a) - (b)))
+    #define R_EQ(a, b)      ((mos6502::i8)((a) == (b) ? 0xFF : 0x00))
+    #define R_MAXU(a, b)    ((a) > (b) ? (a) : (b))
+    #define R_ANY(a)        ((a) != 0)
+#endif
+
+    static const int PARTS = VEC / sizeof(Reg);
+
+    struct Vec{
+        Reg r[PARTS];
+    };
+
+    #define VEC_BINARY(name, op)                                    \
+        static inline Vec name(Vec a, Vec b){                       \
+            Vec v;                                                  \
+            for(int i = 0; i < PARTS; i++){v.r[i] = op(a.r[i], b.r[i]);} \
+            return v;                                               \
+        }
+
+    VEC_BINARY(vand, R_AND)
+    VEC_BINARY(vor, R_OR)
+    VEC_BINARY(vxor, R_XOR)
+    VEC_BINARY(vandnot, R_ANDNOT)   // ~a & b
+    VEC_BINARY(vadd, R_ADD)
+    VEC_BINARY(vsub, R_SUB)
+    VEC_BINARY(veq, R_EQ)
+    VEC_BINARY(vmaxu, R_MAXU)
+
+    #undef VEC_BINARY
+
+    static inline Vec vload(const mos6502::i8 *p){
+        Vec v;
+        for(int i = 0; i < PARTS; i++){
+            v.r[i] = R_LOAD(p + i * sizeof(Reg));
+        }
+        return v;
+    }
+
+    static inline void vstore(mos6502::i8 *p, Vec v){
+        for(int i = 0; i < PARTS; i++){
+            R_STORE(p + i * sizeof(Reg), v.r[i]);
+        }
+    }
+
+    static inline Vec vset(mos6502::i8 x){
+        Vec v;
+        for(int i = 0; i < PARTS; i++){
+            v.r[i] = R_SET1(x);
+        }
+        return v;
+    }
+
+    static inline bool vany(Vec m){
+        for(int i = 0; i < PARTS; i++){
+            if(R_ANY(m.r[i])){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // m ? a : b, PER LANE.
+    static inline Vec vsel(Vec m, Vec a, Vec b){
+        return vor(vand(m, a), vandnot(m, b));
+    }
+
+    // STORE v INTO THE LANES OF m ONLY.
+    static inline void vput(mos6502::i8 *p, Vec m, Vec v){
+        vstore(p, vsel(m, v, vload(p)));
+    }
+
+    // P WITH N AND Z TAKEN FROM v.
+    static inline Vec vnz(Vec p, Vec v){
+        return vor(vand(p, vset(0x7D)), vor(vand(v, vset(0x80)), vand(veq(v, vset(0)), vset(0x02))));
+    }
+
+    // P AFTER A COMPARE OF reg WITH m: C = reg >= m, N/Z FROM reg - m.
+    static inline Vec vcompare(Vec p, Vec reg, Vec m){
+        p = vnz(p, vsub(reg, m));
+        return vor(vand(p, vset(0xFE)), vand(veq(vmaxu(reg, m), reg), vset(0x01)));
+    }
+
+
+    Engine::Engine(int count){
+        this->count = count;
+        this->lanes = (count + VEC - 1) / VEC * VEC;
+        this->A.assign(this->lanes, 0);
+        this->X.assign(this->lanes, 0);
+        this->Y.assign(this->lanes, 0);
+        this->SP.assign(this->lanes, 0);
+        this->P.assign(this->lanes, 0);
+        this->PC.assign(this->lanes, 0);
+        this->cycles.assign(this->lanes, 0);
+        this->end.assign(this->lanes, 0);
+        this->overshoot.assign(this->lanes, 0);
+        this->ram.assign(0x800 * this->lanes, 0);
+        this->sram.assign(0x2000 * this->lanes, 0);
+        this->ppuLatch.assign(0x8 * this->lanes, 0);
+        this->ioLatch.assign(0x20 * this->lanes, 0);
+        this->padButtons.assign(2 * this->lanes, 0);
+        this->padShift.assign(2 * this->lanes, 0);
+        this->padStrobe.assign(this->lanes, 0);
+        this->todo.assign(this->lanes, 0);
+        this->group.assign(this->lanes, 0);
+        memset(this->prg, 0xFF, sizeof(this->prg));
+        this->opINS = &cpu::CPU::opTable[0xEA];
+        this->operand = 0;
+        this->opPC = 0;
+        this->resetStats();
+    }
+
+    void Engine::setPRG(const mos6502::i8 *prg){
+        memcpy(this->prg, prg, sizeof(this->prg));
+    }
+
+    void Engine::reset(){
+        // SAME POWER-ON CONTENTS AS bus::Bus::reset().
+        memset(&this->ram[0], 0, 0x200 * this->lanes);
+        memset(&this->ram[0x200 * this->lanes], 0xFF, (0x800 - 0x200) * this->lanes);
+        memset(&this->sram[0], 0, this->sram.size());
+        memset(&this->ppuLatch[0], 0, this->ppuLatch.size());
+        memset(&this->ioLatch[0], 0, this->ioLatch.size());
+        memset(&this->padButtons[0], 0, this->padButtons.size());
+        memset(&this->padShift[0], 0, this->padShift.size());
+        memset(&this->padStrobe[0], 0, this->padStrobe.size());
+        mos6502::i16 entry = this->prg[0x7FFC] | (this->prg[0x7FFD] << 8);
+        for(int l = 0; l < this->lanes; l++){
+            this->A[l]  = 0;
+            this->X[l]  = 0;
+            this->Y[l]  = 0;
+            this->SP[l] = 0xFD;
+            this->P[l]  = 0x24;
+            this->PC[l] = entry;
+            this->cycles[l] += 7;
+        }
+    }
+
+    void Engine::resetStats(){
+        memset(&this->stats, 0, sizeof(this->stats));
+    }
+
+    mos6502::i8 *Engine::readRow(mos6502::i16 addr){
+        if(addr < 0x2000){
+            return &this->ram[(addr & 0x7FF) * this->lanes];
+        }
+        if(addr < 0x4000){
+            return &this->ppuLatch[(addr & 0x7) * this->lanes];
+        }
+        if(addr < 0x4020){
+            return &this->ioLatch[(addr & 0x1F) * this->lanes];
+        }
+        if(addr >= 0x6000 && addr < 0x8000){
+            return &this->sram[(addr - 0x6000) * this->lanes];
+        }
+        return NULL;
+    }
+
+    mos6502::i8 *Engine::writeRow(mos6502::i16 addr){
+        return addr < 0x8000 ? this->readRow(addr) : NULL;
+    }
+
+    // WHAT EVERY LANE READS AT addr WHEN IT HAS NO ROW: PRG OR OPEN BUS.
+    mos6502::i8 Engine::shared(mos6502::i16 addr){
+        return addr >= 0x8000 ? this->prg[addr - 0x8000] : addr >> 8;
+    }
+
+    void Engine::setInput(int l, int port, mos6502::i8 buttons){
+        int i = (port & 1) * this->lanes + l;
+        this->padButtons[i] = buttons;
+        if(this->padStrobe[l]){
+            this->padShift[i] = buttons;
+        }
+    }
+
+    mos6502::i8 Engine::readPad(int l, mos6502::i16 addr){
+        int i = (addr & 1) * this->lanes + l;
+        if(this->padStrobe[l]){
+            this->padShift[i] = this->padButtons[i];
+        }
+        mos6502::i8 bit = this->padShift[i] & 1;
+        this->padShift[i] = (this->padShift[i] >> 1) | 0x80;
+        return (addr >> 8) | bit;
+    }
+
+    void Engine::writeStrobe(int l, mos6502::i8 data){
+        this->padStrobe[l] = data & 1;
+        if(this->padStrobe[l]){
+            this->padShift[l] = this->padButtons[l];
+            this->padShift[this->lanes + l] = this->padButtons[this->lanes + l];
+        }
+    }
+
+
+    /**
+     * SCALAR CORE, ONE LANE, ONE INSTRUCTION. THE HANDLERS FOLLOW cpu::CPU
+     * LINE BY LINE, WITH P PACKED INSTEAD OF LAZY.
+     */
+    void Engine::stepLane(int l){
+        mos6502::i16 pc = this->PC[l];
+        mos6502::i8 op = this->read(l, pc);
+        this->opINS   = &cpu::CPU::opTable[op];
+        this->opPC    = pc;
+        this->operand = 0;
+        if(this->opINS->bytes >= 2){
+            this->operand = this->read(l, pc + 1);
+        }
+        if(this->opINS->bytes == 3){
+            this->operand |= this->read(l, pc + 2) << 8;
+        }
+        this->PC[l] = pc + this->opINS->bytes;
+        this->cycles[l] += this->opINS->cycles;
+
+        #define LANE_CASE(op, name, mode, bytes, base, pageCross) \
+            case op: this->name(l); break;
+        switch(op){
+            MOS6502_OPCODES(LANE_CASE)
+        }
+        #undef LANE_CASE
+    }
+
+    void Engine::setNZ(int l, mos6502::i8 value){
+        this->P[l] = (this->P[l] & 0x7D) | (value & 0x80) | (value ? 0 : 0x02);
+    }
+
+    void Engine::setFlag(int l, mos6502::i8 mask, bool on){
+        this->P[l] = on ? (this->P[l] | mask) : (this->P[l] & ~mask);
+    }
+
+    mos6502::i16 Engine::effectiveAddress(int l){
+        mos6502::i16 opVal = this->operand;
+        mos6502::i16 base;
+        switch(this->opINS->addrMode){
+            case cpu::CPU::ZEROPAGE:
+                return opVal & 0xFF;
+            case cpu::CPU::ZEROPAGEX:
+                return (opVal + this->X[l]) & 0xFF;
+            case cpu::CPU::ZEROPAGEY:
+                return (opVal + this->Y[l]) & 0xFF;
+            case cpu::CPU::ABSOLUTE:
+                return opVal;
+            case cpu::CPU::ABSOLUTEX:
+                return this->pageCross(l, opVal, opVal + this->X[l]);
+            case cpu::CPU::ABSOLUTEY:
+                return this->pageCross(l, opVal, opVal + this->Y[l]);
+            case cpu::CPU::INDEXED_INDIRECT:{
+                mos6502::i8 zp = opVal + this->X[l];
+                return this->read(l, zp) | (this->read(l, (mos6502::i8)(zp + 1)) << 8);
+                                  }
+            case cpu::CPU::INDIRECT_INDEXED:{
+                mos6502::i8 zp = opVal;
+                base = this->read(l, zp) | (this->read(l, (mos6502::i8)(zp + 1)) << 8);
+                return this->pageCross(l, base, base + this->Y[l]);
+                                  }
+            case cpu::CPU::INDIRECT:
+                return this->read(l, opVal) | (this->read(l, (opVal & 0xFF00) | ((opVal + 1) & 0xFF)) << 8);
+            case cpu::CPU::RELATIVE:
+                return this->PC[l] + (int8_t)opVal;
+        }
+        return opVal;
+    }
+
+    mos6502::i16 Engine::pageCross(int l, mos6502::i16 base, mos6502::i16 addr){
+        this->cycles[l] += this->opINS->pageCross & (((base ^ addr) >> 8) != 0);
+        return addr;
+    }
+
+    mos6502::i8 Engine::readOperand(int l){
+        switch(this->opINS->addrMode){
+            case cpu::CPU::IMPLICIT:
+            case cpu::CPU::ACCEUMULATOR:
+                return this->A[l];
+            case cpu::CPU::IMMEDIATE:
+                return this->operand & 0xFF;
+        }
+        return this->read(l, this->effectiveAddress(l));
+    }
+
+    void Engine::writeOperand(int l, mos6502::i8 value){
+        if(this->opINS->addrMode == cpu::CPU::ACCEUMULATOR){
+            this->A[l] = value;
+            return;
+        }
+        this->write(l, this->effectiveAddress(l), value);
+    }
+
+    void Engine::adc(int l, mos6502::i8 value){
+        mos6502::i8 a = this->A[l];
+        mos6502::i16 sum = a + value + (this->P[l] & 0x01);
+        mos6502::i8 result = sum;
+        this->setFlag(l, 0x01, sum > 0xFF);
+        this->setFlag(l, 0x40, (a ^ result) & (value ^ result) & 0x80);
+        this->A[l] = result;
+        this->setNZ(l, result);
+    }
+
+    void Engine::compare(int l, mos6502::i8 reg, mos6502::i8 value){
+        this->setFlag(l, 0x01, reg >= value);
+        this->setNZ(l, reg - value);
+    }
+
+    void Engine::branch(int l, bool condition){
+        if(condition){
+            mos6502::i16 target = this->PC[l] + (int8_t)this->operand;
+            this->cycles[l] += 1 + (((this->PC[l] ^ target) & 0xFF00) != 0);
+            this->PC[l] = target;
+        }
+    }
+
+    void Engine::push(int l, mos6502::i8 value){
+        this->write(l, 0x100 | this->SP[l], value);
+        this->SP[l]--;
+    }
+
+    mos6502::i8 Engine::pull(int l){
+        this->SP[l]++;
+        return this->read(l, 0x100 | this->SP[l]);
+    }
+
+    void Engine::interrupt(int l, mos6502::i16 vector, mos6502::i8 breakFlag){
+        this->push(l, this->PC[l] >> 8);
+        this->push(l, this->PC[l] & 0xFF);
+        this->push(l, this->P[l] | (breakFlag << 4) | 0x20);
+        this->P[l] |= 0x04;
+        this->PC[l] = this->read(l, vector) | (this->read(l, vector + 1) << 8);
+        this->cycles[l] += 7;
+    }
+
+    static inline mos6502::i8 shiftLeft(mos6502::i8 &p, mos6502::i8 value, mos6502::i8 carryIn){
+        mos6502::i8 result = (value << 1) | carryIn;
+        p = (p & 0x7C) | (value >> 7) | (result & 0x80) | (result ? 0 : 0x02);
+        return result;
+    }
+
+    static inline mos6502::i8 shiftRight(mos6502::i8 &p, mos6502::i8 value, mos6502::i8 carryIn){
+        mos6502::i8 result = (value >> 1) | (carryIn << 7);
+        p = (p & 0x7C) | (value & 0x01) | (result & 0x80) | (result ? 0 : 0x02);
+        return result;
+    }
+
+    void Engine::ADC(int l){this->adc(l, this->readOperand(l));}
+    void Engine::SBC(int l){this->adc(l, ~this->readOperand(l));}
+    void Engine::AND(int l){this->A[l] &= this->readOperand(l); this->setNZ(l, this->A[l]);}
+    void Engine::EOR(int l){this->A[l] ^= this->readOperand(l); this->setNZ(l, this->A[l]);}
+    void Engine::ORA(int l){this->A[l] |= this->readOperand(l); this->setNZ(l, this->A[l]);}
+    void Engine::ASL(int l){this->writeOperand(l, shiftLeft(this->P[l], this->readOperand(l), 0));}
+    void Engine::LSR(int l){this->writeOperand(l, shiftRight(this->P[l], this->readOperand(l), 0));}
+    void Engine::ROL(int l){this->writeOperand(l, shiftLeft(this->P[l], this->readOperand(l), this->P[l] & 0x01));}
+    void Engine::ROR(int l){this->writeOperand(l, shiftRight(this->P[l], this->readOperand(l), this->P[l] & 0x01));}
+    void Engine::BCC(int l){this->branch(l, !(this->P[l] & 0x01));}
+    void Engine::BCS(int l){this->branch(l, this->P[l] & 0x01);}
+    void Engine::BEQ(int l){this->branch(l, this->P[l] & 0x02);}
+    void Engine::BNE(int l){this->branch(l, !(this->P[l] & 0x02));}
+    void Engine::BMI(int l){this->branch(l, this->P[l] & 0x80);}
+    void Engine::BPL(int l){this->branch(l, !(this->P[l] & 0x80));}
+    void Engine::BVC(int l){this->branch(l, !(this->P[l] & 0x40));}
+    void Engine::BVS(int l){this->branch(l, this->P[l] & 0x40);}
+
+    void Engine::BIT(int l){
+        mos6502::i8 value = this->readOperand(l);
+        this->P[l] = (this->P[l] & 0x3D) | (value & 0xC0) | ((this->A[l] & value) ? 0 : 0x02);
+    }
+
+    void Engine::BRK(int l){
+        this->PC[l]++;
+        this->interrupt(l, 0xFFFE, 0x1);
+        this->cycles[l] -= 7;
+    }
+
+    void Engine::CLC(int l){this->P[l] &= ~0x01;}
+    void Engine::SEC(int l){this->P[l] |= 0x01;}
+    void Engine::CLD(int l){this->P[l] &= ~0x08;}
+    void Engine::SED(int l){this->P[l] |= 0x08;}
+    void Engine::CLI(int l){this->P[l] &= ~0x04;}
+    void Engine::SEI(int l){this->P[l] |= 0x04;}
+    void Engine::CLV(int l){this->P[l] &= ~0x40;}
+    void Engine::CMP(int l){this->compare(l, this->A[l], this->readOperand(l));}
+    void Engine::CPX(int l){this->compare(l, this->X[l], this->readOperand(l));}
+    void Engine::CPY(int l){this->compare(l, this->Y[l], this->readOperand(l));}
+
+    void Engine::DEC(int l){
+        mos6502::i8 value = this->readOperand(l) - 1;
+        this->writeOperand(l, value);
+        this->setNZ(l, value);
+    }
+
+    void Engine::INC(int l){
+        mos6502::i8 value = this->readOperand(l) + 1;
+        this->writeOperand(l, value);
+        this->setNZ(l, value);
+    }
+
+    void Engine::DEX(int l){this->X[l]--; this->setNZ(l, this->X[l]);}
+    void Engine::DEY(int l){this->Y[l]--; this->setNZ(l, this->Y[l]);}
+    void Engine::INX(int l){this->X[l]++; this->setNZ(l, this->X[l]);}
+    void Engine::INY(int l){this->Y[l]++; this->setNZ(l, this->Y[l]);}
+    void Engine::JMP(int l){this->PC[l] = this->effectiveAddress(l);}
+
+    void Engine::JSR(int l){
+        mos6502::i16 ret = this->PC[l] - 1;
+        this->push(l, ret >> 8);
+        this->push(l, ret & 0xFF);
+        this->PC[l] = this->operand;
+    }
+
+    void Engine::RTS(int l){
+        mos6502::i16 low = this->pull(l);
+        this->PC[l] = (low | (this->pull(l) << 8)) + 1;
+    }
+
+    void Engine::LDA(int l){this->A[l] = this->readOperand(l); this->setNZ(l, this->A[l]);}
+    void Engine::LDX(int l){this->X[l] = this->readOperand(l); this->setNZ(l, this->X[l]);}
+    void Engine::LDY(int l){this->Y[l] = this->readOperand(l); this->setNZ(l, this->Y[l]);}
+    void Engine::NOP(int l){this->effectiveAddress(l);}
+    void Engine::PHA(int l){this->push(l, this->A[l]);}
+    void Engine::PLA(int l){this->A[l] = this->pull(l); this->setNZ(l, this->A[l]);}
+    void Engine::PHP(int l){this->push(l, this->P[l] | 0x30);}
+    void Engine::PLP(int l){this->P[l] = (this->pull(l) & 0xCF) | 0x20;}
+
+    void Engine::RTI(int l){
+        this->P[l] = (this->pull(l) & 0xCF) | 0x20;
+        mos6502::i16 low = this->pull(l);
+        this->PC[l] = low | (this->pull(l) << 8);
+    }
+
+    void Engine::STA(int l){this->writeOperand(l, this->A[l]);}
+    void Engine::STX(int l){this->writeOperand(l, this->X[l]);}
+    void Engine::STY(int l){this->writeOperand(l, this->Y[l]);}
+    void Engine::TAX(int l){this->X[l] = this->A[l]; this->setNZ(l, this->X[l]);}
+    void Engine::TXA(int l){this->A[l] = this->X[l]; this->setNZ(l, this->A[l]);}
+    void Engine::TYA(int l){this->A[l] = this->Y[l]; this->setNZ(l, this->A[l]);}
+    void Engine::TAY(int l){this->Y[l] = this->A[l]; this->setNZ(l, this->Y[l]);}
+    void Engine::TSX(int l){this->X[l] = this->SP[l]; this->setNZ(l, this->X[l]);}
+    void Engine::TXS(int l){this->SP[l] = this->X[l];}
+
+    // UNOFFICIAL OP CODE
+    void Engine::KIL(int l){this->PC[l] = this->opPC;}
+
+    void Engine::SLO(int l){
+        mos6502::i8 value = shiftLeft(this->P[l], this->readOperand(l), 0);
+        this->writeOperand(l, value);
+        this->A[l] |= value;
+        this->setNZ(l, this->A[l]);
+    }
+
+    void Engine::RLA(int l){
+        mos6502::i8 value = shiftLeft(this->P[l], this->readOperand(l), this->P[l] & 0x01);
+        this->writeOperand(l, value);
+        this->A[l] &= value;
+        this->setNZ(l, this->A[l]);
+    }
+
+    void Engine::SRE(int l){
+        mos6502::i8 value = shiftRight(this->P[l], this->readOperand(l), 0);
+        this->writeOperand(l, value);
+        this->A[l] ^= value;
+        this->setNZ(l, this->A[l]);
+    }
+
+    void Engine::RRA(int l){
+        mos6502::i8 value = shiftRight(this->P[l], this->readOperand(l), this->P[l] & 0x01);
+        this->writeOperand(l, value);
+        this->adc(l, value);
+    }
+
+    void Engine::SAX(int l){this->writeOperand(l, this->A[l] & this->X[l]);}
+
+    void Engine::LAX(int l){
+        this->A[l] = this->readOperand(l);
+        this->X[l] = this->A[l];
+        this->setNZ(l, this->A[l]);
+    }
+
+    void Engine::DCP(int l){
+        mos6502::i8 value = this->readOperand(l) - 1;
+        this->writeOperand(l, value);
+        this->compare(l, this->A[l], value);
+    }
+
+    void Engine::ISC(int l){
+        mos6502::i8 value = this->readOperand(l) + 1;
+        this->writeOperand(l, value);
+        this->adc(l, ~value);
+    }
+
+    void Engine::ANC(int l){
+        this->A[l] &= this->readOperand(l);
+        this->setNZ(l, this->A[l]);
+        this->setFlag(l, 0x01, this->A[l] & 0x80);
+    }
+
+    void Engine::ALR(int l){
+        this->A[l] = shiftRight(this->P[l], this->A[l] & this->readOperand(l), 0);
+    }
+
+    void Engine::XAA(int l){
+        this->A[l] = (this->A[l] | 0xEE) & this->X[l] & this->readOperand(l);
+        this->setNZ(l, this->A[l]);
+    }
+
+    void Engine::TAS(int l){
+        mos6502::i16 addr = this->effectiveAddress(l);
+        this->SP[l] = this->A[l] & this->X[l];
+        this->write(l, addr, this->SP[l] & ((addr >> 8) + 1));
+    }
+
+    void Engine::LAS(int l){
+        this->A[l] = this->readOperand(l) & this->SP[l];
+        this->X[l] = this->A[l];
+        this->SP[l] = this->A[l];
+        this->setNZ(l, this->A[l]);
+    }
+
+    void Engine::AXS(int l){
+        mos6502::i8 value = this->readOperand(l);
+        this->compare(l, this->A[l] & this->X[l], value);
+        this->X[l] = (this->A[l] & this->X[l]) - value;
+    }
+
+    void Engine::SHY(int l){
+        mos6502::i16 addr = this->effectiveAddress(l);
+        this->write(l, addr, this->Y[l] & ((addr >> 8) + 1));
+    }
+
+    void Engine::AHX(int l){
+        mos6502::i16 addr = this->effectiveAddress(l);
+        this->write(l, addr, this->A[l] & this->X[l] & ((addr >> 8) + 1));
+    }
+
+    void Engine::ARR(int l){
+        // A = (A&#) ROR 1, C = BIT 6, V = BIT 6 ^ BIT 5
+        mos6502::i8 value = this->A[l] & this->readOperand(l);
+        this->A[l] = (value >> 1) | ((this->P[l] & 0x01) << 7);
+        this->setNZ(l, this->A[l]);
+        this->setFlag(l, 0x01, this->A[l] & 0x40);
+        this->setFlag(l, 0x40, ((this->A[l] << 1) ^ (this->A[l] << 2)) & 0x80);
+    }
+
+    void Engine::SHX(int l){
+        mos6502::i16 addr = this->effectiveAddress(l);
+        this->write(l, addr, this->X[l] & ((addr >> 8) + 1));
+    }
+
+
+    /**
+     * VECTOR KERNELS. EVERY LANE OF THE GROUP IS AT pc, SO THEY ALL RUN THE
+     * SAME OPCODE WITH THE SAME OPERAND, AND AN IMMEDIATE, ZERO PAGE OR
+     * ABSOLUTE OPERAND IS THE SAME ROW (OR SHARED BYTE) FOR ALL OF THEM.
+     */
+    enum Kernel{
+        K_NONE,
+        K_LOAD,         // r1 (AND r2) = M, NZ
+        K_LOGIC,        // A = A op M, NZ
+        K_COMPARE,      // r1 - M, NZC
+        K_BIT,
+        K_STORE,        // M = r1 (& r2)
+        K_STEP,         // M = M + delta, NZ
+        K_TRANSFER,     // r2 = r1 + delta, NZ UNLESS TXS
+        K_FLAG,         // P = (P & ~mask) | set
+        K_BRANCH,       // TAKEN WHEN (P & mask) == set
+        K_JUMP,
+        K_NOP,
+    };
+
+    bool Engine::stepGroup(const OpINS &ins, mos6502::i16 pc, mos6502::i16 operand, int first){
+        typedef cpu::CPU C;
+        C::opHandler h = ins.opHandler;
+        int mode = ins.addrMode;
+        bool direct = mode == C::IMMEDIATE || mode == C::ZEROPAGE || mode == C::ABSOLUTE;
+        bool memory = mode == C::ZEROPAGE || mode == C::ABSOLUTE;
+
+        Kernel kernel = K_NONE;
+        mos6502::i8 *r1 = NULL, *r2 = NULL;
+        mos6502::i8 mask = 0, set = 0;
+        int logic = 0, delta = 0;
+        bool flags = true;
+
+        if(direct && (h == &C::LDA || h == &C::LDX || h == &C::LDY || h == &C::LAX)){
+            kernel = K_LOAD;
+            r1 = h == &C::LDX ? &this->X[0] : h == &C::LDY ? &this->Y[0] : &this->A[0];
+            r2 = h == &C::LAX ? &this->X[0] : NULL;
+        }else if(direct && (h == &C::AND || h == &C::ORA || h == &C::EOR)){
+            kernel = K_LOGIC;
+            logic = h == &C::AND ? 0 : h == &C::ORA ? 1 : 2;
+        }else if(direct && (h == &C::CMP || h == &C::CPX || h == &C::CPY)){
+            kernel = K_COMPARE;
+            r1 = h == &C::CPX ? &this->X[0] : h == &C::CPY ? &this->Y[0] : &this->A[0];
+        }else if(memory && h == &C::BIT){
+            kernel = K_BIT;
+        }else if(memory && (h == &C::STA || h == &C::STX || h == &C::STY || h == &C::SAX)){
+            kernel = K_STORE;
+            r1 = h == &C::STX ? &this->X[0] : h == &C::STY ? &this->Y[0] : &this->A[0];
+            r2 = h == &C::SAX ? &this->X[0] : NULL;
+        }else if(memory && (h == &C::INC || h == &C::DEC)){
+            kernel = K_STEP;
+            delta = h == &C::INC ? 1 : -1;
+        }else if(h == &C::TAX || h == &C::TAY || h == &C::TXA || h == &C::TYA || h == &C::TSX || h == &C::TXS){
+            kernel = K_TRANSFER;
+            r1 = (h == &C::TXA || h == &C::TXS) ? &this->X[0] : h == &C::TYA ? &this->Y[0] : h == &C::TSX ? &this->SP[0] : &this->A[0];
+            r2 = (h == &C::TAX || h == &C::TSX) ? &this->X[0] : h == &C::TAY ? &this->Y[0] : h == &C::TXS ? &this->SP[0] : &this->A[0];
+            flags = h != &C::TXS;
+        }else if(h == &C::INX || h == &C::INY || h == &C::DEX || h == &C::DEY){
+            kernel = K_TRANSFER;
+            r1 = r2 = (h == &C::INX || h == &C::DEX) ? &this->X[0] : &this->Y[0];
+            delta = (h == &C::INX || h == &C::INY) ? 1 : -1;
+        }else if(h == &C::CLC || h == &C::SEC || h == &C::CLI || h == &C::SEI || h == &C::CLD || h == &C::SED || h == &C::CLV){
+            kernel = K_FLAG;
+            mask = (h == &C::CLC || h == &C::SEC) ? 0x01 : (h == &C::CLI || h == &C::SEI) ? 0x04 : (h == &C::CLD || h == &C::SED) ? 0x08 : 0x40;
+            set  = (h == &C::SEC || h == &C::SEI || h == &C::SED) ? mask : 0;
+        }else if(mode == C::RELATIVE){
+            kernel = K_BRANCH;
+            mask = (h == &C::BPL || h == &C::BMI) ? 0x80 : (h == &C::BVC || h == &C::BVS) ? 0x40 : (h == &C::BCC || h == &C::BCS) ? 0x01 : 0x02;
+            set  = (h == &C::BMI || h == &C::BVS || h == &C::BCS || h == &C::BEQ) ? mask : 0;
+        }else if(h == &C::JMP && mode == C::ABSOLUTE){
+            kernel = K_JUMP;
+        }else if(h == &C::NOP && (direct || mode == C::IMPLICIT)){
+            kernel = K_NOP;
+        }
+        if(kernel == K_NONE){
+            return false;
+        }
+
+        // THE OPERAND, SAME FOR EVERY LANE OF THE GROUP.
+        mos6502::i16 addr = mode == C::ZEROPAGE ? operand & 0xFF : operand;
+        if(memory && (addr & 0xFFFE) == 0x4016){
+            return false;           // THE PADS HAVE PER LANE SIDE EFFECTS, SEE read()/write()
+        }
+        mos6502::i8 *source = mode == C::IMMEDIATE ? NULL : this->readRow(addr);
+        mos6502::i8 *target = this->writeRow(addr);
+        Vec constant = vset(mode == C::IMMEDIATE ? operand & 0xFF : this->shared(addr));
+
+        mos6502::i16 next   = pc + ins.bytes;
+        mos6502::i16 branch = next + (int8_t)operand;
+        mos6502::i8 penalty = 1 + (((next ^ branch) & 0xFF00) != 0);
+        mos6502::i8 *P = &this->P[0];
+        mos6502::i8 *A = &this->A[0];
+
+        for(int c = first & ~(VEC - 1); c < this->lanes; c += VEC){
+            mos6502::i8 *group = &this->group[c];
+            Vec g = vload(group);
+            if(!vany(g)){
+                continue;
+            }
+            Vec m = source ? vload(source + c) : constant;
+            Vec p = vload(P + c);
+            switch(kernel){
+                case K_LOAD:
+                    vput(r1 + c, g, m);
+                    if(r2){
+                        vput(r2 + c, g, m);
+                    }
+                    vput(P + c, g, vnz(p, m));
+                    break;
+                case K_LOGIC:{
+                    Vec a = vload(A + c);
+                    a = logic == 0 ? vand(a, m) : logic == 1 ? vor(a, m) : vxor(a, m);
+                    vput(A + c, g, a);
+                    vput(P + c, g, vnz(p, a));
+                    break;
+                             }
+                case K_COMPARE:
+                    vput(P + c, g, vcompare(p, vload(r1 + c), m));
+                    break;
+                case K_BIT:{
+                    Vec z = vand(veq(vand(vload(A + c), m), vset(0)), vset(0x02));
+                    vput(P + c, g, vor(vand(p, vset(0x3D)), vor(vand(m, vset(0xC0)), z)));
+                    break;
+                           }
+                case K_STORE:
+                    if(target){
+                        Vec v = vload(r1 + c);
+                        vput(target + c, g, r2 ? vand(v, vload(r2 + c)) : v);
+                    }
+                    break;
+                case K_STEP:{
+                    Vec v = vadd(m, vset(delta));
+                    if(target){
+                        vput(target + c, g, v);
+                    }
+                    vput(P + c, g, vnz(p, v));
+                    break;
+                            }
+                case K_TRANSFER:{
+                    Vec v = vadd(vload(r1 + c), vset(delta));
+                    vput(r2 + c, g, v);
+                    if(flags){
+                        vput(P + c, g, vnz(p, v));
+                    }
+                    break;
+                                }
+                case K_FLAG:
+                    vput(P + c, g, vor(vand(p, vset(~mask)), vset(set)));
+                    break;
+                case K_BRANCH:{
+                    // PC AND CYCLES ARE 16/64 BIT, SO ONLY THE CONDITION IS VECTOR.
+                    mos6502::i8 taken[VEC];
+                    vstore(taken, vand(g, veq(vand(p, vset(mask)), vset(set))));
+                    for(int i = 0; i < VEC; i++){
+                        if(group[i]){
+                            this->PC[c + i]      = taken[i] ? branch : next;
+                            this->cycles[c + i] += ins.cycles + (taken[i] ? penalty : 0);
+                        }
+                    }
+                    continue;
+                              }
+                case K_JUMP:
+                    for(int i = 0; i < VEC; i++){
+                        if(group[i]){
+                            this->PC[c + i]      = operand;
+                            this->cycles[c + i] += ins.cycles;
+                        }
+                    }
+                    continue;
+                case K_NOP:
+                case K_NONE:
+                    break;
+            }
+            // BRANCHLESS SO THE COMPILER CAN VECTORIZE IT TOO.
+            mos6502::i16 *pcs = &this->PC[c];
+            uint64_t *clocks = &this->cycles[c];
+            for(int i = 0; i < VEC; i++){
+                pcs[i]     = group[i] ? next : pcs[i];
+                clocks[i] += group[i] & ins.cycles;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * ONE ROUND PER LOOP: EVERY LANE STILL SHORT OF end RUNS ONE INSTRUCTION.
+     * THE FIRST UNSERVED LANE PICKS THE PC, EVERY UNSERVED LANE AT THAT PC
+     * JOINS ITS GROUP. CODE OUTSIDE PRG MAY DIFFER BETWEEN LANES, SO IT IS
+     * NEVER GROUPED.
+     */
+    void Engine::run(){
+        for(;;){
+            mos6502::i8 active = 0;
+            for(int l = 0; l < this->lanes; l++){
+                this->todo[l] = this->cycles[l] < this->end[l] ? 0xFF : 0x00;
+                active |= this->todo[l];
+            }
+            if(!active){
+                return;
+            }
+            this->stats.steps++;
+
+            int first = 0;
+            for(;;){
+                while(first < this->lanes && !this->todo[first]){
+                    first++;
+                }
+                if(first >= this->lanes){
+                    break;
+                }
+                this->stats.groups++;
+                mos6502::i16 pc = this->PC[first];
+                const OpINS &ins = cpu::CPU::opTable[this->shared(pc)];
+                if(pc < 0x8000 || pc + ins.bytes - 1 > 0xFFFF){
+                    this->stepLane(first);
+                    this->todo[first] = 0;
+                    this->stats.scalarLanes++;
+                    continue;
+                }
+                int members = 0;
+                for(int l = first & ~(VEC - 1); l < this->lanes; l++){
+                    mos6502::i8 in = (this->todo[l] && this->PC[l] == pc) ? 0xFF : 0x00;
+                    this->group[l] = in;
+                    this->todo[l] &= ~in;
+                    members += in & 1;
+                }
+                mos6502::i16 operand = 0;
+                if(ins.bytes >= 2){
+                    operand = this->prg[pc + 1 - 0x8000];
+                }
+                if(ins.bytes == 3){
+                    operand |= this->prg[pc + 2 - 0x8000] << 8;
+                }
+                if(this->stepGroup(ins, pc, operand, first)){
+                    this->stats.vectorLanes += members;
+                    continue;
+                }
+                for(int l = first; l < this->lanes; l++){
+                    if(this->group[l]){
+                        this->stepLane(l);
+                    }
+                }
+                this->stats.scalarLanes += members;
+            }
+        }
+    }
+
+    void Engine::runCycles(uint32_t budget){
+        for(int l = 0; l < this->count; l++){
+            this->end[l] = this->cycles[l] + budget;
+        }
+        this->run();
+    }
+
+    // SAME VBLANK AS cpu::CPU::runFrame(): BIT 7 OF PPUSTATUS AND AN NMI IF
+    // PPUCTRL ENABLES IT, DROPPED AGAIN AFTER VBLANK_CYCLES.
+    void Engine::runFrame(){
+        mos6502::i8 *control = &this->ppuLatch[0];
+        mos6502::i8 *status  = &this->ppuLatch[2 * this->lanes];
+        for(int l = 0; l < this->count; l++){
+            this->end[l] = this->cycles[l] - this->overshoot[l] + cpu::CPU::VBLANK_CYCLES;
+            status[l] |= 0x80;
+            if(control[l] & 0x80){
+                this->interrupt(l, 0xFFFA, 0);
+            }
+        }
+        this->run();
+        for(int l = 0; l < this->count; l++){
+            this->end[l] += cpu::CPU::CYCLES_PER_FRAME - cpu::CPU::VBLANK_CYCLES;
+            status[l] &= 0x7F;
+        }
+        this->run();
+        for(int l = 0; l < this->count; l++){
+            this->overshoot[l] = this->cycles[l] - this->end[l];
+        }
+    }
+
+    void Engine::nmi(){
+        for(int l = 0; l < this->count; l++){
+            this->interrupt(l, 0xFFFA, 0);
+        }
+    }
+
+    void Engine::irq(){
+        for(int l = 0; l < this->count; l++){
+            if(!(this->P[l] & 0x04)){
+                this->interrupt(l, 0xFFFE, 0);
+            }
+        }
+    }
+
+    Engine::~Engine(){
+
+    }
+
+};
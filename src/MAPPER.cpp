@@ -0,0 +1,332 @@
+#include "../include/MAPPER.h"
+#include "../include/CPU.h"
+#include <map>
+#include <string.h>
+
+namespace mapper{
+
+    static const uint32_t SLOT = 0x2000;
+
+    Mapper::Mapper(const rom::ROM &rom, cpu::CPU &cpu) : rom(&rom), cpu(&cpu){
+        this->cart     = &cpu.getCart();
+        this->prg      = rom.getPRG(0).data;
+        this->prgBanks = rom.getPRGBanks() * (rom::ROM::PRG_BANK_SIZE / SLOT);
+        this->chr      = rom.getCHRBanks() > 0 ? rom.getCHR(0).data : NULL;
+        this->chrBanks = rom.getCHRBanks() * (rom::ROM::CHR_BANK_SIZE / 0x400);
+        memset(this->mapped, 0, sizeof(this->mapped));
+        // READS STAY ON THE PAGES setPRG8() MAPS, WRITES COME HERE.
+        cpu.getBus().mapHandler(0x8000, 0xFFFF, NULL, &Mapper::writeRegister, this);
+        cpu.setMapper(this);
+    }
+
+    Mapper::~Mapper(){
+        this->cpu->setMapper(NULL);
+        this->cpu->getBus().mapPRG();
+    }
+
+    void Mapper::writeRegister(void *context, mos6502::i16 addr, mos6502::i8 data){
+        ((Mapper *)context)->write(addr, data);
+    }
+
+    void Mapper::reset(){
+        memset(this->cart, 0, sizeof(*this->cart));
+        this->cart->mirroring = this->rom->hasFourScreen() ? FOUR_SCREEN : this->rom->getMirroring();
+        this->power();
+    }
+
+    void Mapper::restore(){
+        memset(this->mapped, 0, sizeof(this->mapped));
+        for(int slot = 0; slot < 4; slot++){
+            this->setPRG8(slot, this->cart->prg[slot]);
+        }
+    }
+
+    void Mapper::setPRG8(int slot, uint32_t bank){
+        bank %= this->prgBanks;
+        this->cart->prg[slot] = bank;
+        const mos6502::i8 *memory = this->prg + bank * SLOT;
+        if(this->mapped[slot] != memory){
+            this->mapped[slot] = memory;
+            // READ ONLY, SO THE BUS NEVER WRITES THROUGH IT.
+            mos6502::i16 start = 0x8000 + slot * SLOT;
+            this->cpu->getBus().mapMemory(start, start + SLOT - 1, const_cast<mos6502::i8 *>(memory), SLOT, false);
+        }
+    }
+
+    void Mapper::setPRG16(int slot, uint32_t bank){
+        this->setPRG8(slot * 2, bank * 2);
+        this->setPRG8(slot * 2 + 1, bank * 2 + 1);
+    }
+
+    void Mapper::setPRG32(uint32_t bank){
+        this->setPRG16(0, bank * 2);
+        this->setPRG16(1, bank * 2 + 1);
+    }
+
+    void Mapper::setCHR1(int slot, uint32_t bank){
+        this->cart->chr[slot] = this->chrBanks ? bank % this->chrBanks : bank & 0x7;
+    }
+
+    void Mapper::setCHR4(int slot, uint32_t bank){
+        for(int i = 0; i < 4; i++){
+            this->setCHR1(slot * 4 + i, bank * 4 + i);
+        }
+    }
+
+    void Mapper::setCHR8(uint32_t bank){
+        this->setCHR4(0, bank * 2);
+        this->setCHR4(1, bank * 2 + 1);
+    }
+
+    const mos6502::i8 *Mapper::getCHR(int slot) const{
+        return this->chr ? this->chr + this->cart->chr[slot] * 0x400 : NULL;
+    }
+
+    // NROM: THE FIRST 16 KB AT $8000, THE LAST AT $C000.
+    void Mapper::power(){
+        this->setPRG16(0, 0);
+        this->setPRG16(1, this->prgBanks / 2 - 1);
+        this->setCHR8(0);
+    }
+
+    void Mapper::write(mos6502::i16 addr, mos6502::i8 data){
+    }
+
+
+    /**
+     * MMC1 (SxROM). FIVE WRITES OF BIT 0 SHIFT A VALUE IN, THE FIFTH PICKS THE
+     * REGISTER BY ADDRESS: CONTROL, CHR 0, CHR 1, PRG. BIT 7 CLEARS THE SHIFT.
+     * ON 512 KB BOARDS (SUROM) BIT 4 OF CHR 0 SELECTS THE 256 KB HALF.
+     */
+    class MMC1 : public Mapper{
+
+        private:
+
+            enum{SHIFT, COUNT, CONTROL, CHR0, CHR1, PRG};
+
+            void update(){
+                mos6502::i8 *r = this->cart->regs;
+                static const mos6502::i8 mirrorings[4] = {SINGLE_LOW, SINGLE_HIGH, VERTICAL, HORIZONTAL};
+                this->cart->mirroring = mirrorings[r[CONTROL] & 0x3];
+
+                uint32_t outer = this->prgBanks > 32 ? (r[CHR0] & 0x10) : 0;
+                uint32_t bank  = r[PRG] & 0x0F;
+                switch((r[CONTROL] >> 2) & 0x3){
+                    case 0:
+                    case 1:
+                        this->setPRG16(0, outer | (bank & 0x0E));
+                        this->setPRG16(1, outer | (bank | 0x01));
+                        break;
+                    case 2:
+                        this->setPRG16(0, outer);
+                        this->setPRG16(1, outer | bank);
+                        break;
+                    case 3:
+                        this->setPRG16(0, outer | bank);
+                        this->setPRG16(1, outer | 0x0F);
+                        break;
+                }
+                if(r[CONTROL] & 0x10){
+                    this->setCHR4(0, r[CHR0]);
+                    this->setCHR4(1, r[CHR1]);
+                }else{
+                    this->setCHR8(r[CHR0] >> 1);
+                }
+            }
+
+        protected:
+
+            void power(){
+                this->cart->regs[CONTROL] = 0x0C;
+                this->update();
+            }
+
+            void write(mos6502::i16 addr, mos6502::i8 data){
+                mos6502::i8 *r = this->cart->regs;
+                if(data & 0x80){
+                    r[SHIFT] = 0;
+                    r[COUNT] = 0;
+                    r[CONTROL] |= 0x0C;
+                    this->update();
+                    return;
+                }
+                r[SHIFT] |= (data & 0x1) << r[COUNT];
+                if(++r[COUNT] < 5){
+                    return;
+                }
+                r[CONTROL + ((addr >> 13) & 0x3)] = r[SHIFT];
+                r[SHIFT] = 0;
+                r[COUNT] = 0;
+                this->update();
+            }
+
+        public:
+
+            MMC1(const rom::ROM &rom, cpu::CPU &cpu) : Mapper(rom, cpu){}
+            const char *getName() const{return "MMC1";}
+    };
+
+    // UxROM: 16 KB AT $8000 PICKED BY ANY WRITE, THE LAST 16 KB FIXED AT $C000.
+    class UxROM : public Mapper{
+
+        protected:
+
+            void write(mos6502::i16 addr, mos6502::i8 data){
+                this->setPRG16(0, data);
+            }
+
+        public:
+
+            UxROM(const rom::ROM &rom, cpu::CPU &cpu) : Mapper(rom, cpu){}
+            const char *getName() const{return "UxROM";}
+    };
+
+    // CNROM: NROM PRG, 8 KB OF CHR PICKED BY ANY WRITE.
+    class CNROM : public Mapper{
+
+        protected:
+
+            void write(mos6502::i16 addr, mos6502::i8 data){
+                this->setCHR8(data);
+            }
+
+        public:
+
+            CNROM(const rom::ROM &rom, cpu::CPU &cpu) : Mapper(rom, cpu){}
+            const char *getName() const{return "CNROM";}
+    };
+
+    /**
+     * MMC3 (TxROM). $8000 SELECTS ONE OF R0-R7 AND THE PRG/CHR LAYOUT, $8001
+     * SETS IT: R0/R1 ARE 2 KB CHR, R2-R5 1 KB CHR, R6/R7 8 KB PRG, THE
+     * SECOND TO LAST 8 KB AT $8000 OR $C000 AND THE LAST AT $E000. $A000 IS
+     * MIRRORING, $C000-$FFFF THE SCANLINE IRQ, COUNTED BY scanline().
+     */
+    class MMC3 : public Mapper{
+
+        private:
+
+            enum{SELECT, R0, RAM_PROTECT = R0 + 8, IRQ_LATCH, IRQ_COUNTER, IRQ_RELOAD, IRQ_ENABLE};
+
+            void update(){
+                mos6502::i8 *r = this->cart->regs;
+                uint32_t secondLast = this->prgBanks - 2;
+                if(r[SELECT] & 0x40){
+                    this->setPRG8(0, secondLast);
+                    this->setPRG8(2, r[R0 + 6]);
+                }else{
+                    this->setPRG8(0, r[R0 + 6]);
+                    this->setPRG8(2, secondLast);
+                }
+                this->setPRG8(1, r[R0 + 7]);
+                this->setPRG8(3, this->prgBanks - 1);
+
+                // CHR INVERSION SWAPS THE 2 KB HALF AND THE 1 KB HALF.
+                int big = (r[SELECT] & 0x80) ? 4 : 0;
+                int small = big ^ 4;
+                this->setCHR1(big + 0, r[R0] & 0xFE);
+                this->setCHR1(big + 1, r[R0] | 0x01);
+                this->setCHR1(big + 2, r[R0 + 1] & 0xFE);
+                this->setCHR1(big + 3, r[R0 + 1] | 0x01);
+                for(int i = 0; i < 4; i++){
+                    this->setCHR1(small + i, r[R0 + 2 + i]);
+                }
+            }
+
+        protected:
+
+            void power(){
+                static const mos6502::i8 banks[8] = {0, 2, 4, 5, 6, 7, 0, 1};
+                memcpy(this->cart->regs + R0, banks, sizeof(banks));
+                this->update();
+            }
+
+            void write(mos6502::i16 addr, mos6502::i8 data){
+                mos6502::i8 *r = this->cart->regs;
+                switch((addr & 0xE000) | (addr & 0x1)){
+                    case 0x8000: r[SELECT] = data; this->update(); break;
+                    case 0x8001: r[R0 + (r[SELECT] & 0x7)] = data; this->update(); break;
+                    case 0xA000:
+                        if(this->cart->mirroring != FOUR_SCREEN){
+                            this->cart->mirroring = (data & 0x1) ? HORIZONTAL : VERTICAL;
+                        }
+                        break;
+                    case 0xA001: r[RAM_PROTECT] = data; break;
+                    case 0xC000: r[IRQ_LATCH] = data; break;
+                    case 0xC001: r[IRQ_COUNTER] = 0; r[IRQ_RELOAD] = 1; break;
+                    case 0xE000: r[IRQ_ENABLE] = 0; this->cart->irq = 0; break;
+                    case 0xE001: r[IRQ_ENABLE] = 1; break;
+                }
+            }
+
+        public:
+
+            MMC3(const rom::ROM &rom, cpu::CPU &cpu) : Mapper(rom, cpu){}
+            const char *getName() const{return "MMC3";}
+
+            void scanline(){
+                mos6502::i8 *r = this->cart->regs;
+                if(r[IRQ_COUNTER] == 0 || r[IRQ_RELOAD]){
+                    r[IRQ_COUNTER] = r[IRQ_LATCH];
+                    r[IRQ_RELOAD] = 0;
+                }else{
+                    r[IRQ_COUNTER]--;
+                }
+                if(r[IRQ_COUNTER] == 0 && r[IRQ_ENABLE]){
+                    this->cart->irq = 1;
+                }
+            }
+    };
+
+    // AxROM: 32 KB PICKED BY BITS 0-2 OF ANY WRITE, ONE SCREEN MIRRORING BY BIT 4.
+    class AxROM : public Mapper{
+
+        protected:
+
+            void power(){
+                this->setPRG32(0);
+                this->setCHR8(0);
+                this->cart->mirroring = SINGLE_LOW;
+            }
+
+            void write(mos6502::i16 addr, mos6502::i8 data){
+                this->setPRG32(data & 0x7);
+                this->cart->mirroring = (data & 0x10) ? SINGLE_HIGH : SINGLE_LOW;
+            }
+
+        public:
+
+            AxROM(const rom::ROM &rom, cpu::CPU &cpu) : Mapper(rom, cpu){}
+            const char *getName() const{return "AxROM";}
+    };
+
+    template<class T> static Mapper *make(const rom::ROM &rom, cpu::CPU &cpu){
+        return new T(rom, cpu);
+    }
+
+    static std::map<int, Factory> &registry(){
+        static std::map<int, Factory> factories = {
+            {0, &make<Mapper>},
+            {1, &make<MMC1>},
+            {2, &make<UxROM>},
+            {3, &make<CNROM>},
+            {4, &make<MMC3>},
+            {7, &make<AxROM>},
+        };
+        return factories;
+    }
+
+    Mapper *create(const rom::ROM &rom, cpu::CPU &cpu){
+        std::map<int, Factory> &factories = registry();
+        std::map<int, Factory>::const_iterator found = factories.find(rom.getMapperType());
+        return found != factories.end() ? found->second(rom, cpu) : new Mapper(rom, cpu);
+    }
+
+    void add(int number, Factory factory){
+        registry()[number] = factory;
+    }
+
+    bool isSupported(int number){
+        return registry().count(number) != 0;
+    }
+};
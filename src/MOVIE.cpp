@@ -0,0 +1,203 @@
+#include "../include/MOVIE.h"
+#include "../include/REWIND.h"
+#include <fstream>
+#include <iostream>
+#include <string.h>
+
+namespace movie{
+
+    Movie::Movie(){
+        this->zero.assign(sizeof(state::Machine), 0);
+        this->scratch.resize(history::maxEncoded(sizeof(state::Machine)));
+        this->create(0);
+    }
+
+    void Movie::create(uint32_t romCRC, int ports, uint32_t interval){
+        Header header = {MAGIC, VERSION, romCRC, 0, (uint32_t)(ports == 2 ? 2 : 1), interval ? interval : 1, 0,
+                         state::VERSION, (uint32_t)sizeof(state::Machine), 0};
+        this->header = header;
+        this->inputs.clear();
+        this->index.clear();
+        this->blobs.clear();
+    }
+
+    void Movie::append(const mos6502::i8 *input, const state::Machine &machine){
+        uint32_t frame = this->header.frames;
+        if(frame % this->header.interval == 0){
+            size_t length = history::encode((const mos6502::i8 *)&machine, &this->zero[0], sizeof(machine), &this->scratch[0]);
+            Keyframe keyframe = {frame, (uint32_t)this->blobs.size(), (uint32_t)length};
+            this->index.push_back(keyframe);
+            this->blobs.insert(this->blobs.end(), this->scratch.begin(), this->scratch.begin() + length);
+        }
+        this->inputs.insert(this->inputs.end(), input, input + this->header.ports);
+        this->header.frames++;
+    }
+
+    void Movie::truncate(uint32_t frames){
+        if(frames >= this->header.frames){
+            return;
+        }
+        this->header.frames = frames;
+        this->inputs.resize(frames * this->header.ports);
+        // KEYFRAMES STRICTLY BEFORE frames STAY, THE ONE AT frames IS
+        // RE-TAKEN BY THE NEXT append().
+        this->index.resize((frames + this->header.interval - 1) / this->header.interval);
+        this->blobs.resize(this->index.empty() ? 0 : this->index.back().offset + this->index.back().length);
+    }
+
+    int Movie::save(const char *path){
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if(!file){
+            std::cout<<"file '"<<path<<"' open filed"<<std::endl;
+            return -1;
+        }
+        this->header.keyframes = this->index.size();
+        file.write((const char *)&this->header, sizeof(this->header));
+        file.write((const char *)this->inputs.data(), this->inputs.size());
+        file.write((const char *)this->index.data(), this->index.size() * sizeof(Keyframe));
+        file.write((const char *)this->blobs.data(), this->blobs.size());
+        return file ? 0 : -1;
+    }
+
+    int Movie::load(const char *path){
+        std::ifstream file(path, std::ios::binary);
+        if(!file){
+            std::cout<<"file '"<<path<<"' open filed"<<std::endl;
+            return -1;
+        }
+        Header header;
+        if(!file.read((char *)&header, sizeof(header)) || header.magic != MAGIC || header.version != VERSION
+           || (header.ports != 1 && header.ports != 2) || !header.interval
+           || header.keyframes != (header.frames + header.interval - 1) / header.interval){
+            std::cout<<"file '"<<path<<"' is not a version "<<VERSION<<" movie"<<std::endl;
+            return -1;
+        }
+        if(header.stateVersion != state::VERSION || header.stateSize != sizeof(state::Machine)){
+            std::cout<<"file '"<<path<<"' was recorded with savestate version "<<header.stateVersion<<std::endl;
+            return -1;
+        }
+        std::vector<mos6502::i8> inputs((size_t)header.frames * header.ports);
+        std::vector<Keyframe> index(header.keyframes);
+        if(!file.read((char *)inputs.data(), inputs.size()) || !file.read((char *)index.data(), index.size() * sizeof(Keyframe))){
+            return -1;
+        }
+        // KEYFRAMES ARE CONTIGUOUS AND IN ORDER; ANYTHING ELSE IS CORRUPT.
+        size_t total = 0;
+        for(size_t i = 0; i < index.size(); i++){
+            if(index[i].frame != i * header.interval || index[i].offset != total
+               || index[i].length > this->scratch.size()){
+                return -1;
+            }
+            total += index[i].length;
+        }
+        std::vector<mos6502::i8> blobs(total);
+        if(!file.read((char *)blobs.data(), blobs.size())){
+            return -1;
+        }
+        // EVERY TOKEN OF EVERY KEYFRAME MUST STAY INSIDE THE ARENA, SO restore()
+        // CAN TRUST THEM.
+        std::vector<mos6502::i8> decoded(sizeof(state::Machine));
+        for(size_t i = 0; i < index.size(); i++){
+            if(!history::apply(&blobs[index[i].offset], index[i].length, &decoded[0], decoded.size())){
+                std::cout<<"file '"<<path<<"' has a corrupt keyframe at frame "<<index[i].frame<<std::endl;
+                return -1;
+            }
+        }
+        this->header = header;
+        this->inputs.swap(inputs);
+        this->index.swap(index);
+        this->blobs.swap(blobs);
+        return 0;
+    }
+
+    uint32_t Movie::restore(uint32_t frame, state::Machine &machine){
+        if(this->index.empty()){
+            return 0;
+        }
+        size_t i = frame / this->header.interval;
+        if(i >= this->index.size()){
+            i = this->index.size() - 1;
+        }
+        const Keyframe &keyframe = this->index[i];
+        mos6502::i8 *data = (mos6502::i8 *)&machine;
+        memset(data, 0, sizeof(machine));
+        history::apply(&this->blobs[keyframe.offset], keyframe.length, data, sizeof(machine));
+        return keyframe.frame;
+    }
+
+    // SAME STATE, SAME ENCODING: COMPARE THE ENCODED BYTES, NO DECODE NEEDED.
+    bool Movie::matches(uint32_t frame, const state::Machine &machine){
+        const Keyframe &keyframe = this->index[frame / this->header.interval];
+        size_t length = history::encode((const mos6502::i8 *)&machine, &this->zero[0], sizeof(machine), &this->scratch[0]);
+        return length == keyframe.length && !memcmp(&this->scratch[0], &this->blobs[keyframe.offset], length);
+    }
+
+    Movie::~Movie(){
+
+    }
+
+    Player::Player(Movie &movie, cpu::CPU &cpu, nes::JoyPads &pads) : movie(&movie), cpu(&cpu), pads(&pads){
+        this->frame = 0;
+    }
+
+    void Player::run(uint32_t frame){
+        this->pads->set(0, this->movie->getInput(frame, 0));
+        this->pads->set(1, this->movie->getInput(frame, 1));
+        this->cpu->runFrame();
+    }
+
+    bool Player::step(){
+        if(this->frame >= this->movie->getFrames()){
+            return false;
+        }
+        this->run(this->frame++);
+        return true;
+    }
+
+    uint32_t Player::seek(uint32_t frame){
+        if(frame > this->movie->getFrames()){
+            frame = this->movie->getFrames();
+        }
+        uint32_t interval = this->movie->getInterval();
+        uint32_t keyframe = frame - frame % interval;
+        if(keyframe / interval >= this->movie->getKeyframes() && this->movie->getKeyframes()){
+            keyframe = (this->movie->getKeyframes() - 1) * interval;
+        }
+        if(this->movie->getKeyframes() && (frame < this->frame || this->frame < keyframe)){
+            state::Machine machine;
+            this->frame = this->movie->restore(frame, machine);
+            this->cpu->loadState(machine);
+        }
+        uint32_t replayed = frame > this->frame ? frame - this->frame : 0;
+        while(this->frame < frame){
+            this->run(this->frame++);
+        }
+        return replayed;
+    }
+
+    void Player::record(const mos6502::i8 *input){
+        this->movie->truncate(this->frame);
+        this->movie->append(input, this->cpu->getState());
+        this->run(this->frame++);
+    }
+
+    uint32_t Player::verify(uint32_t &checked){
+        uint32_t mismatches = 0;
+        checked = 0;
+        while(this->frame < this->movie->getFrames()){
+            if(this->movie->isKeyframe(this->frame)){
+                checked++;
+                if(!this->movie->matches(this->frame, this->cpu->getState())){
+                    mismatches++;
+                }
+            }
+            this->run(this->frame++);
+        }
+        return mismatches;
+    }
+
+    Player::~Player(){
+
+    }
+
+};
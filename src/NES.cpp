@@ -1,21 +1,120 @@
 #include "../include/NES.h"
 
 namespace nes{
-        NES::NES(){
-        }
 
-        mos6502::i8 NES::loadProgram(){
+    NES::NES(){
+        this->rom    = NULL;
+        this->mapper = NULL;
+        this->save   = NULL;
+        this->cpu    = new cpu::CPU();
+        this->pads = new JoyPads(this->cpu->getBus(), this->cpu->getPads());
+        this->ppu  = new ppu::PPU();
+        this->apu  = new APU();
+    }
 
+    int NES::loadRom(const char *path){
+        rom::ROM *rom = new rom::ROM();
+        if(rom->loadNesFile(path) != 0){
+            delete rom;
+            rom = NULL;
         }
+        return this->insert(rom);
+    }
 
-        mos6502::i8 NES::run(){
+    int NES::loadRom(const mos6502::i8 *data, size_t size){
+        rom::ROM *rom = new rom::ROM();
+        if(rom->loadNesData(data, size) != 0){
+            delete rom;
+            rom = NULL;
+        }
+        return this->insert(rom);
+    }
 
+    int NES::insert(rom::ROM *rom){
+        delete this->save;
+        this->save = NULL;
+        delete this->mapper;
+        this->mapper = NULL;
+        delete this->rom;
+        this->rom = NULL;
+        this->ppu->reset();
+        if(rom == NULL || rom->getPRGBanks() == 0){
+            delete rom;
+            return -1;
+        }
+        this->rom = rom;
+        this->mapper = mapper::create(*this->rom, *this->cpu);
+        if(this->rom->getCHRBanks() > 0){
+            rom::Span chr = this->rom->getCHR(0);
+            this->ppu->loadCHR(chr.data, chr.size);
         }
+        return this->reset();
+    }
 
-        mos6502::i8 NES::reset(){
+    // POWER ON FROM A BLANK ARENA, SO A RESET OR RELOADED NES RUNS EXACTLY
+    // LIKE A NEW ONE. THE BATTERY KEEPS SRAM THROUGH IT.
+    int NES::reset(){
+        if(this->rom == NULL){
+            return -1;
+        }
+        if(this->save){
+            this->save->update(true);
+        }
+        state::Machine blank;
+        this->cpu->loadState(blank);
+        this->cpu->reset();
+        this->mapper->reset();
+        if(this->save){
+            this->save->load();
+        }
+        this->cpu->readResetVector();
+        return 0;
+    }
 
+    int NES::openSave(const char *path, uint32_t interval){
+        delete this->save;
+        this->save = NULL;
+        if(this->rom == NULL || !this->rom->hasBatteryRam()){
+            return -1;
         }
+        battery::Save *save = new battery::Save();
+        bus::Bus &bus = this->cpu->getBus();
+        if(save->open(path, bus.getSRAM(), sizeof(state::Memory::sram), interval) != 0){
+            delete save;
+            return -1;
+        }
+        this->save = save;
+        return 0;
+    }
+
+    void NES::setInput(int port, mos6502::i8 mask){
+        this->pads->set(port, mask);
+    }
 
-        NES::~NES(){
+    uint32_t NES::stepFrame(){
+        if(this->rom == NULL){
+            return 0;
+        }
+        uint32_t cycles = this->cpu->runFrame();
+        if(this->save){
+            this->save->update();
         }
+        return cycles;
+    }
+
+    const mos6502::i8 *NES::framebuffer(){
+        return this->ppu->getFrame();
+    }
+
+    // THE PADS AND THE MAPPER MAP OVER THE CPU'S BUS, AND THE SAVE READS ITS
+    // SRAM, SO THEY GO FIRST.
+    NES::~NES(){
+        delete this->save;
+        delete this->pads;
+        delete this->mapper;
+        delete this->cpu;
+        delete this->rom;
+        delete this->apu;
+        delete this->ppu;
+    }
 };
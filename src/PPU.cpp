@@ -1,10 +1,47 @@
 #include "../include/PPU.h"
+#include <string.h>
 
 
 namespace ppu{
 
+    const uint32_t PALETTE[64] = {
+        0x666666, 0x002A88, 0x1412A7, 0x3B00A4, 0x5C007E, 0x6E0040, 0x6C0600, 0x561D00,
+        0x333500, 0x0B4800, 0x005200, 0x004F08, 0x00404D, 0x000000, 0x000000, 0x000000,
+        0xADADAD, 0x155FD9, 0x4240FF, 0x7527FE, 0xA01ACC, 0xB71E7B, 0xB53120, 0x994E00,
+        0x6B6D00, 0x388700, 0x0C9300, 0x008F32, 0x007C8D, 0x000000, 0x000000, 0x000000,
+        0xFFFEFF, 0x64B0FF, 0x9290FF, 0xC676FF, 0xF36AFF, 0xFE6ECC, 0xFE8170, 0xEA9E22,
+        0xBCBE00, 0x88D800, 0x5CE430, 0x45E082, 0x48CDDE, 0x4F4F4F, 0x000000, 0x000000,
+        0xFFFEFF, 0xC0DFFF, 0xD3D2FF, 0xE8C8FF, 0xFBC2FF, 0xFEC4EA, 0xFECCC5, 0xF7D8A5,
+        0xE4E594, 0xCFEF96, 0xBDF4AB, 0xB3F3CC, 0xB5EBF2, 0xB8B8B8, 0x000000, 0x000000,
+    };
+
+    // BLACK, DARK GREY, LIGHT GREY, WHITE FOR THE FOUR PIXEL VALUES OF A TILE.
+    static const mos6502::i8 GREYS[4] = {0x0F, 0x00, 0x10, 0x30};
+
     PPU::PPU(){
+        this->version = 0;
+        this->reset();
+    }
 
+    void PPU::reset(){
+        memset(this->frame, GREYS[0], sizeof(this->frame));
+        this->version++;
+    }
+
+    // TABLE 0 ON THE LEFT, TABLE 1 ON THE RIGHT, EACH 16 X 16 TILES.
+    void PPU::loadCHR(const mos6502::i8 *chr, size_t size){
+        this->reset();
+        for(int t = 0; t < 512 && (size_t)t * 16 + 16 <= size; t++){
+            int x = (t >> 8) * 128 + (t & 0xF) * 8;
+            int y = ((t >> 4) & 0xF) * 8;
+            for(int row = 0; row < 8; row++){
+                mos6502::i8 pixels[8];
+                this->addTileInt8(chr[t * 16 + row], chr[t * 16 + 8 + row], pixels);
+                for(int i = 0; i < 8; i++){
+                    this->frame[(y + row) * WIDTH + x + i] = GREYS[pixels[i]];
+                }
+            }
+        }
     }
 
     void PPU::step(){
@@ -0,0 +1,194 @@
+#include "../include/REWIND.h"
+#include <string.h>
+
+namespace history{
+
+    // TOKEN FIELDS ARE u16, WHICH COVERS THE WHOLE ARENA.
+    static_assert(sizeof(state::Machine) < 0x10000, "state::Machine too large for the rewind codec");
+
+    static inline uint64_t load64(const mos6502::i8 *p){
+        uint64_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    static inline void put16(mos6502::i8 *p, size_t value){
+        p[0] = value & 0xFF;
+        p[1] = value >> 8;
+    }
+
+    size_t encode(const mos6502::i8 *data, const mos6502::i8 *ref, size_t size, mos6502::i8 *out){
+        size_t pos = 0;
+        size_t length = 0;
+        while(pos < size){
+            size_t start = pos;
+            while(pos + 8 <= size && load64(data + pos) == load64(ref + pos)){
+                pos += 8;
+            }
+            while(pos < size && data[pos] == ref[pos]){
+                pos++;
+            }
+            if(pos == size){
+                break;                      // TRAILING EQUAL BYTES NEED NO TOKEN
+            }
+            size_t literal = pos;
+            size_t same = 0;
+            while(pos < size && same < 8){
+                same = data[pos] == ref[pos] ? same + 1 : 0;
+                pos++;
+            }
+            pos -= same;
+            put16(out + length, literal - start);
+            put16(out + length + 2, pos - literal);
+            length += 4;
+            for(size_t i = literal; i < pos; i++){
+                out[length++] = data[i] ^ ref[i];
+            }
+        }
+        return length;
+    }
+
+    bool apply(const mos6502::i8 *in, size_t length, mos6502::i8 *data, size_t size){
+        size_t pos = 0;
+        size_t at = 0;
+        while(pos < length){
+            if(length - pos < 4){
+                return false;
+            }
+            size_t skip  = in[pos] | (in[pos + 1] << 8);
+            size_t count = in[pos + 2] | (in[pos + 3] << 8);
+            pos += 4;
+            if(count > length - pos || skip + count > size - at){
+                return false;
+            }
+            at += skip;
+            for(size_t i = 0; i < count; i++){
+                data[at + i] ^= in[pos + i];
+            }
+            at  += count;
+            pos += count;
+        }
+        return true;
+    }
+
+    Buffer::Buffer(size_t capacity, int interval){
+        // ROOM FOR AT LEAST TWO WORST CASE KEYFRAMES, SO ONE GROUP ALWAYS FITS.
+        size_t minimum = 2 * maxEncoded(sizeof(state::Machine));
+        this->ring.resize(capacity < minimum ? minimum : capacity);
+        this->interval = interval > 0 ? interval : 1;
+        this->key.resize(sizeof(state::Machine));
+        this->scratch.resize(maxEncoded(sizeof(state::Machine)));
+        this->clear();
+    }
+
+    void Buffer::clear(){
+        this->entries.clear();
+        this->head = 0;
+        this->sinceKey = 0;
+        this->used = 0;
+        memset(&this->stats, 0, sizeof(this->stats));
+    }
+
+    // THE OLDEST ENTRY AND EVERY DELTA THAT NEEDS IT.
+    void Buffer::dropOldest(){
+        do{
+            this->used -= this->entries.front().length;
+            this->entries.pop_front();
+            this->stats.dropped++;
+        }while(!this->entries.empty() && !this->entries.front().keyframe);
+    }
+
+    // FIND length FREE BYTES AT head, EVICTING THE OLDEST GROUPS AS NEEDED.
+    size_t Buffer::reserve(size_t length){
+        size_t offset = this->head;
+        if(offset + length > this->ring.size()){
+            // THE END OF THE RING IS TOO SHORT. WHATEVER STILL LIVES THERE IS
+            // OLDER THAN EVERYTHING AT THE START, SO IT GOES FIRST.
+            while(!this->entries.empty() && this->entries.front().offset >= offset){
+                this->dropOldest();
+            }
+            offset = 0;
+        }
+        while(!this->entries.empty()){
+            const Entry &oldest = this->entries.front();
+            if(oldest.offset >= offset + length || oldest.offset + oldest.length <= offset){
+                break;
+            }
+            this->dropOldest();
+        }
+        return offset;
+    }
+
+    void Buffer::push(const state::Machine &machine){
+        const mos6502::i8 *data = (const mos6502::i8 *)&machine;
+        bool keyframe = this->entries.empty() || this->sinceKey >= this->interval;
+        size_t length = 0;
+        size_t offset = 0;
+        for(int attempt = 0; attempt < 2; attempt++){
+            if(keyframe){
+                memset(&this->key[0], 0, this->key.size());
+            }
+            length = encode(data, &this->key[0], sizeof(machine), &this->scratch[0]);
+            offset = this->reserve(length);
+            // EVICTION TOOK THE DELTA'S OWN KEYFRAME: STORE A KEYFRAME INSTEAD.
+            if(keyframe || !this->entries.empty()){
+                break;
+            }
+            keyframe = true;
+        }
+        memcpy(&this->ring[offset], &this->scratch[0], length);
+        if(keyframe){
+            memcpy(&this->key[0], data, this->key.size());
+            this->sinceKey = 0;
+            this->stats.keyframes++;
+        }
+        Entry entry = {offset, length, keyframe};
+        this->entries.push_back(entry);
+        this->head = offset + length;
+        this->used += length;
+        this->sinceKey++;
+
+        this->stats.frames++;
+        this->stats.raw += sizeof(machine);
+        this->stats.encoded += length;
+    }
+
+    int Buffer::rewind(int frames, state::Machine &machine){
+        int latest = (int)this->entries.size() - 1;
+        if(frames > latest){
+            frames = latest;
+        }
+        if(frames <= 0){
+            return 0;
+        }
+        int target = latest - frames;
+        int keyframe = target;
+        while(!this->entries[keyframe].keyframe){
+            keyframe--;
+        }
+
+        const Entry &key = this->entries[keyframe];
+        memset(&this->key[0], 0, this->key.size());
+        apply(&this->ring[key.offset], key.length, &this->key[0], this->key.size());
+        mos6502::i8 *data = (mos6502::i8 *)&machine;
+        memcpy(data, &this->key[0], this->key.size());
+        if(target != keyframe){
+            const Entry &delta = this->entries[target];
+            apply(&this->ring[delta.offset], delta.length, data, sizeof(machine));
+        }
+
+        // THE FUTURE IS GONE: THE NEXT push() LANDS RIGHT AFTER target.
+        while((int)this->entries.size() > target + 1){
+            this->used -= this->entries.back().length;
+            this->entries.pop_back();
+        }
+        this->head = this->entries.back().offset + this->entries.back().length;
+        this->sinceKey = target - keyframe + 1;
+        return frames;
+    }
+
+    Buffer::~Buffer(){
+
+    }
+
+};
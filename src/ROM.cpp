@@ -2,16 +2,44 @@
 #include <iostream>
 #include <fstream>
 #include <bitset>
+#include <string.h>
+#include <algorithm>
+// SHA-1 ON THE SHA EXTENSIONS WHEN THE CPU HAS THEM (CHECKED AT RUN TIME).
+// BUILD WITH -D NO_SHA_NI TO DROP IT.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(NO_SHA_NI)
+    #define HAVE_SHA_NI 1
+#include <immintrin.h>
+#include <cpuid.h>
+#endif
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+// .nes.gz AND .zip THROUGH ZLIB. BUILD WITH -D NO_ZLIB (AND WITHOUT -lz) TO DROP IT.
+#ifndef NO_ZLIB
+    #define HAVE_ZLIB 1
+#include <zlib.h>
+#include <climits>
+#endif
+#include <strings.h>
 
 
 namespace rom{
 
     ROM::ROM(){
-        this->mapperNames.reserve(92);
-        for (int i = 0; i < 92; i++) {
-                this->mapperNames[i] = "Unknown Mapper";
-                  
-        }
+        this->image     = NULL;
+        this->imageSize = 0;
+        this->mapping   = NULL;
+        this->mappingSize = 0;
+        this->prgOffset = 0;
+        this->prgBanks  = 0;
+        this->chrOffset = 0;
+        this->chrBanks  = 0;
+        this->nes2      = false;
+        this->verbose   = true;
+        this->mapperNames.assign(92, "Unknown Mapper");
         this->mapperNames[0] = "Direct Access";
         this->mapperNames[1] = "Nintendo MMC1";
         this->mapperNames[2] = "UNROM";
@@ -50,60 +78,500 @@ namespace rom{
         this->mapperNames[91] = "Pirate HK-SF3 chip";
     }
 
-    std::vector<mos6502::i8> readFile(const char* filename)
-    {
-        // open the file:
-        std::streampos fileSize;
-        std::ifstream file(filename, std::ios::binary);
-     
-        // get its size:
-        file.seekg(0, std::ios::end);
-        fileSize = file.tellg();
-        file.seekg(0, std::ios::beg);
-     
-        // read the data:
-        std::vector<mos6502::i8> fileData(fileSize);
-        file.read((char*) &fileData[0], fileSize);
-        return fileData;
-     
+    // BUILT ON FIRST USE; A FUNCTION LOCAL STATIC IS THREAD SAFE, SO WORKERS
+    // HASHING ROMS AT THE SAME TIME ARE FINE. entries[k][b] IS THE CRC OF b
+    // FOLLOWED BY k ZERO BYTES, SO EIGHT LOOKUPS CONSUME EIGHT BYTES AT ONCE
+    // (SLICING BY 8) INSTEAD OF ONE LOOKUP, AND ONE DEPENDENCY, PER BYTE.
+    struct CRCTable{
+        uint32_t entries[8][256];
+        CRCTable(){
+            for(uint32_t i = 0; i < 256; i++){
+                uint32_t c = i;
+                for(int k = 0; k < 8; k++){
+                    c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+                }
+                this->entries[0][i] = c;
+            }
+            for(uint32_t i = 0; i < 256; i++){
+                for(int k = 1; k < 8; k++){
+                    uint32_t c = this->entries[k - 1][i];
+                    this->entries[k][i] = this->entries[0][c & 0xFF] ^ (c >> 8);
+                }
+            }
+        }
+    };
+
+    static inline uint32_t littleEndian32(const mos6502::i8 *p){
+        return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    static inline uint16_t littleEndian16(const mos6502::i8 *p){
+        return p[0] | (p[1] << 8);
+    }
+
+    uint32_t crc32(const mos6502::i8 *data, size_t size, uint32_t crc){
+        static const CRCTable table;
+        const uint32_t (*t)[256] = table.entries;
+        crc = ~crc;
+        for(; size >= 8; data += 8, size -= 8){
+            uint32_t one = littleEndian32(data) ^ crc;
+            uint32_t two = littleEndian32(data + 4);
+            crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24]
+                ^ t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+        }
+        for(size_t i = 0; i < size; i++){
+            crc = t[0][(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    static inline uint32_t rotl(uint32_t x, int n){
+        return (x << n) | (x >> (32 - n));
+    }
+
+    static void sha1Block(uint32_t h[5], const mos6502::i8 *block){
+        uint32_t w[80];
+        for(int i = 0; i < 16; i++){
+            w[i] = ((uint32_t)block[i * 4] << 24) | (block[i * 4 + 1] << 16) | (block[i * 4 + 2] << 8) | block[i * 4 + 3];
+        }
+        for(int i = 16; i < 80; i++){
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+        // ONE LOOP PER ROUND FUNCTION, SO NONE OF THEM BRANCHES.
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        #define SHA1_ROUND(f, k, i)                                   \
+            {                                                         \
+                uint32_t temp = rotl(a, 5) + (f) + e + (k) + w[i];    \
+                e = d;                                                \
+                d = c;                                                \
+                c = rotl(b, 30);                                      \
+                b = a;                                                \
+                a = temp;                                             \
+            }
+        for(int i = 0; i < 20; i++){
+            SHA1_ROUND(d ^ (b & (c ^ d)), 0x5A827999, i)
+        }
+        for(int i = 20; i < 40; i++){
+            SHA1_ROUND(b ^ c ^ d, 0x6ED9EBA1, i)
+        }
+        for(int i = 40; i < 60; i++){
+            SHA1_ROUND((b & c) | (d & (b | c)), 0x8F1BBCDC, i)
+        }
+        for(int i = 60; i < 80; i++){
+            SHA1_ROUND(b ^ c ^ d, 0xCA62C1D6, i)
+        }
+        #undef SHA1_ROUND
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+#ifdef HAVE_SHA_NI
+    // blocks 64 BYTE BLOCKS, FOUR ROUNDS PER sha1rnds4. THE MESSAGE SCHEDULE
+    // RUNS AHEAD IN FOUR REGISTERS THAT TAKE TURNS; PAST ROUND 64 IT WORKS ON
+    // WORDS NOTHING READS, WHICH COSTS LESS THAN SPELLING THE TAIL OUT.
+    __attribute__((target("sha,ssse3,sse4.1")))
+    static void sha1Blocks(uint32_t h[5], const mos6502::i8 *data, size_t blocks){
+        const __m128i MASK = _mm_set_epi64x(0x0001020304050607ULL, 0x08090A0B0C0D0E0FULL);
+        __m128i ABCD = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)h), 0x1B);
+        __m128i E0 = _mm_set_epi32(h[4], 0, 0, 0);
+        __m128i E1, M0, M1, M2, M3;
+
+        #define SHA1_ROUNDS4(E, OTHER, M, NEXT, AFTER, LAST, f) \
+            E     = _mm_sha1nexte_epu32(E, M);                  \
+            OTHER = ABCD;                                       \
+            NEXT  = _mm_sha1msg2_epu32(NEXT, M);                \
+            ABCD  = _mm_sha1rnds4_epu32(ABCD, E, f);            \
+            LAST  = _mm_sha1msg1_epu32(LAST, M);                \
+            AFTER = _mm_xor_si128(AFTER, M);
+
+        for(; blocks > 0; blocks--, data += 64){
+            __m128i savedABCD = ABCD, savedE = E0;
+            M0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data +  0)), MASK);
+            M1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16)), MASK);
+            M2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 32)), MASK);
+            M3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 48)), MASK);
+
+            E0   = _mm_add_epi32(E0, M0);
+            E1   = ABCD;
+            ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 0);
+
+            E1   = _mm_sha1nexte_epu32(E1, M1);
+            E0   = ABCD;
+            ABCD = _mm_sha1rnds4_epu32(ABCD, E1, 0);
+            M0   = _mm_sha1msg1_epu32(M0, M1);
+
+            E0   = _mm_sha1nexte_epu32(E0, M2);
+            E1   = ABCD;
+            ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 0);
+            M1   = _mm_sha1msg1_epu32(M1, M2);
+            M0   = _mm_xor_si128(M0, M2);
+
+            SHA1_ROUNDS4(E1, E0, M3, M0, M1, M2, 0)     // 12-15
+            SHA1_ROUNDS4(E0, E1, M0, M1, M2, M3, 0)     // 16-19
+            SHA1_ROUNDS4(E1, E0, M1, M2, M3, M0, 1)
+            SHA1_ROUNDS4(E0, E1, M2, M3, M0, M1, 1)
+            SHA1_ROUNDS4(E1, E0, M3, M0, M1, M2, 1)
+            SHA1_ROUNDS4(E0, E1, M0, M1, M2, M3, 1)
+            SHA1_ROUNDS4(E1, E0, M1, M2, M3, M0, 1)     // 36-39
+            SHA1_ROUNDS4(E0, E1, M2, M3, M0, M1, 2)
+            SHA1_ROUNDS4(E1, E0, M3, M0, M1, M2, 2)
+            SHA1_ROUNDS4(E0, E1, M0, M1, M2, M3, 2)
+            SHA1_ROUNDS4(E1, E0, M1, M2, M3, M0, 2)
+            SHA1_ROUNDS4(E0, E1, M2, M3, M0, M1, 2)     // 56-59
+            SHA1_ROUNDS4(E1, E0, M3, M0, M1, M2, 3)
+            SHA1_ROUNDS4(E0, E1, M0, M1, M2, M3, 3)
+            SHA1_ROUNDS4(E1, E0, M1, M2, M3, M0, 3)
+            SHA1_ROUNDS4(E0, E1, M2, M3, M0, M1, 3)
+            SHA1_ROUNDS4(E1, E0, M3, M0, M1, M2, 3)     // 76-79
+
+            E0   = _mm_sha1nexte_epu32(E0, savedE);
+            ABCD = _mm_add_epi32(ABCD, savedABCD);
+        }
+        #undef SHA1_ROUNDS4
+
+        _mm_storeu_si128((__m128i *)h, _mm_shuffle_epi32(ABCD, 0x1B));
+        h[4] = _mm_extract_epi32(E0, 3);
+    }
+
+    static bool hasShaNi(){
+        unsigned a, b, c, d;
+        if(!__get_cpuid(1, &a, &b, &c, &d) || !(c & bit_SSE4_1) || !(c & bit_SSSE3)){
+            return false;
+        }
+        return __get_cpuid_count(7, 0, &a, &b, &c, &d) && (b & (1 << 29));
+    }
+#endif
+
+    void sha1(const mos6502::i8 *data, size_t size, mos6502::i8 digest[20]){
+        uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+        size_t whole = size & ~(size_t)63;
+#ifdef HAVE_SHA_NI
+        static const bool shaNi = hasShaNi();
+        if(shaNi){
+            sha1Blocks(h, data, whole / 64);
+        }else
+#endif
+        for(size_t i = 0; i < whole; i += 64){
+            sha1Block(h, data + i);
+        }
+        // THE TAIL, 0x80, ZEROS AND THE BIT LENGTH: ONE OR TWO MORE BLOCKS.
+        mos6502::i8 tail[128] = {0};
+        size_t rest = size - whole;
+        memcpy(tail, data + whole, rest);
+        tail[rest] = 0x80;
+        size_t blocks = rest < 56 ? 1 : 2;
+        uint64_t bits = (uint64_t)size * 8;
+        for(int i = 0; i < 8; i++){
+            tail[blocks * 64 - 1 - i] = (mos6502::i8)(bits >> (i * 8));
+        }
+        for(size_t i = 0; i < blocks; i++){
+            sha1Block(h, tail + i * 64);
+        }
+        for(int i = 0; i < 20; i++){
+            digest[i] = (mos6502::i8)(h[i / 4] >> (24 - (i % 4) * 8));
+        }
+    }
+
+    // PRG AND CHR FOLLOW EACH OTHER IN THE FILE, SO THIS IS ONE PASS.
+    uint32_t ROM::getCRC32(){
+        return crc32(this->image + this->prgOffset,
+                     this->prgBanks * PRG_BANK_SIZE + this->chrBanks * CHR_BANK_SIZE);
+    }
+
+    void ROM::getSHA1(mos6502::i8 digest[20]){
+        sha1(this->image + this->prgOffset,
+             this->prgBanks * PRG_BANK_SIZE + this->chrBanks * CHR_BANK_SIZE, digest);
+    }
+
+    // NES 2.0 HAS ITS OWN BYTE FOR IT; OLD iNES ONLY FLAGS 9 (FLAGS 10 IS
+    // UNOFFICIAL AND OFTEN RIPPER JUNK).
+    TVSystem ROM::getTVSystem() const{
+        if(this->nes2){
+            static const TVSystem systems[4] = {NTSC, PAL, DUAL, PAL};
+            return systems[this->header[12] & 3];
+        }
+        return (this->f9 & 1) ? PAL : NTSC;
+    }
+
+    void ROM::unload(){
+#ifndef WIN32
+        if(this->mapping != NULL){
+            munmap(this->mapping, this->mappingSize);
+        }
+#endif
+        this->owned.reset();
+        this->mapping   = NULL;
+        this->mappingSize = 0;
+        this->image     = NULL;
+        this->imageSize = 0;
+        this->prgBanks  = 0;
+        this->chrBanks  = 0;
     }
 
     mos6502::i8 ROM::loadNesFile(const char* file){
-        std::fstream nesFile;
-        nesFile.open(file,std::ios::binary | std::ios::in);
+        this->unload();
+#ifndef WIN32
+        int fd = open(file, O_RDONLY);
+        struct stat info;
+        if(fd < 0 || fstat(fd, &info) != 0){
+            if(fd >= 0){
+                close(fd);
+            }
+            if(this->verbose){
+                std::cout<<"file '"<<file<<"' open filed"<<std::endl;
+            }
+            return -1;
+        }
+        void *mapped = info.st_size > 0 ? mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        close(fd);
+        if(mapped == MAP_FAILED){
+            if(this->verbose){
+                std::cout<<"file '"<<file<<"' open filed"<<std::endl;
+            }
+            return -1;
+        }
+        this->mapping     = mapped;
+        this->mappingSize = info.st_size;
+        const mos6502::i8 *data = (const mos6502::i8 *)mapped;
+        size_t size = info.st_size;
+#else
+        std::ifstream nesFile(file, std::ios::binary);
         if(!nesFile){
-            std::cout<<"file '"<<file<<"' open filed"<<std::endl;
-            return -1;
-        }
-
-        std::vector<mos6502::i8> prog;
-        
-        // int clm = 0;
-        // int line = 0;
-        while(nesFile){
-            char c;
-            nesFile.get(c);
-            if(nesFile){
-                //if(line<1){
-                // if(clm==0){
-                //     std::cout<<line<<": ";
-                // }
-                //if(((0x000000ff)&int(c))<0x10){
-                //     std::cout<<"0X0"<<std::hex<<((0x000000ff)&int(c))<<" ";
-                //}else{
-                //     std::cout<<"0X"<<std::hex<<((0x000000ff)&int(c))<<" ";
-                // }
-                // clm++;
-                // if(clm==0x10){
-                //     clm = 0;
-                //     std::cout<<std::endl;
-                //     line++;
-                // }
-                //}
-                prog.push_back(0xFF & (unsigned char)c);
+            if(this->verbose){
+                std::cout<<"file '"<<file<<"' open filed"<<std::endl;
             }
+            return -1;
+        }
+        nesFile.seekg(0, std::ios::end);
+        size_t size = (size_t)nesFile.tellg();
+        nesFile.seekg(0, std::ios::beg);
+        std::unique_ptr<mos6502::i8[]> buffer(new mos6502::i8[size]);
+        nesFile.read((char *)buffer.get(), size);
+        const mos6502::i8 *data = buffer.get();
+#endif
+        mos6502::i8 result;
+        if(size >= 2 && data[0] == 0x1F && data[1] == 0x8B){
+            result = this->loadGzip(data, size);
+        }else if(size >= 4 && littleEndian32(data) == 0x04034B50){
+            result = this->loadZip(data, size);
+        }else{
+            this->image     = data;
+            this->imageSize = size;
+            result = this->parse();
+        }
+        if(result != 0){
+            this->unload();
+            return -1;
+        }
+#ifndef WIN32
+        // INFLATED: THE COMPRESSED FILE IS NOT NEEDED ANY MORE.
+        if(this->owned){
+            munmap(this->mapping, this->mappingSize);
+            this->mapping     = NULL;
+            this->mappingSize = 0;
+        }
+#else
+        if(!this->owned){
+            this->owned = std::move(buffer);
         }
+#endif
+        return 0;
+    }
 
+    mos6502::i8 ROM::loadNesData(const mos6502::i8 *prog, size_t size){
+        this->unload();
+        this->owned.reset(new mos6502::i8[size]);
+        memcpy(this->owned.get(), prog, size);
+        this->image     = this->owned.get();
+        this->imageSize = size;
+        if(this->parse() != 0){
+            this->unload();
+            return -1;
+        }
+        return 0;
+    }
+
+    // NES 2.0: FLAGS 7 BITS 2-3 ARE 10, AND FLAGS 9 HOLDS THE HIGH NIBBLES OF
+    // THE BANK COUNTS. AN MSB NIBBLE OF F MEANS THE EXPONENT-MULTIPLIER FORM,
+    // WHICH ONLY NON-STANDARD DUMPS USE AND THE BANKS CANNOT MAP: FALSE.
+    static bool countBanks(const mos6502::i8 *header, size_t &prgBanks, size_t &chrBanks){
+        prgBanks = header[4];
+        chrBanks = header[5];
+        if((header[7] & 0x0C) == 0x08){
+            if((header[9] & 0x0F) == 0x0F || (header[9] & 0xF0) == 0xF0){
+                return false;
+            }
+            prgBanks |= (size_t)(header[9] & 0x0F) << 8;
+            chrBanks |= (size_t)(header[9] & 0xF0) << 4;
+        }
+        return true;
+    }
+
+    mos6502::i8 ROM::loadGzip(const mos6502::i8 *data, size_t size){
+        // 16 + MAX_WBITS: ZLIB READS THE GZIP WRAPPER AND CHECKS ITS CRC AND
+        // ISIZE ITSELF. ISIZE, THE LAST 4 BYTES, IS THE SIZE MOD 2^32.
+        if(size < 18){
+            return -1;
+        }
+        return this->inflateImage(data, size, littleEndian32(data + size - 4), 16 + 15, NULL);
+    }
+
+    // ZIP: THE CENTRAL DIRECTORY AT THE END NAMES THE ENTRIES AND WHERE THEY
+    // START; THE LOCAL HEADER THERE IS ONLY SKIPPED. NO ZIP64, NO ENCRYPTION.
+    mos6502::i8 ROM::loadZip(const mos6502::i8 *data, size_t size){
+        // END OF CENTRAL DIRECTORY: 22 BYTES, THEN A COMMENT OF UP TO 64 KB.
+        if(size < 22){
+            return -1;
+        }
+        size_t end = size - 22;
+        size_t stop = end > 0xFFFF ? end - 0xFFFF : 0;
+        while(littleEndian32(data + end) != 0x06054B50){
+            if(end-- == stop){
+                if(this->verbose){
+                    std::cout<<"not a zip archive"<<std::endl;
+                }
+                return -1;
+            }
+        }
+        uint16_t entries = littleEndian16(data + end + 10);
+        size_t directory = littleEndian32(data + end + 16);
+        size_t directoryEnd = directory + littleEndian32(data + end + 12);
+        if(directoryEnd > end){
+            return -1;
+        }
+
+        // THE FIRST .nes ENTRY, OR THE ONLY ENTRY.
+        const mos6502::i8 *chosen = NULL;
+        for(size_t i = 0, at = directory; i < entries; i++){
+            if(at + 46 > directoryEnd || littleEndian32(data + at) != 0x02014B50){
+                break;
+            }
+            size_t name = littleEndian16(data + at + 28);
+            if(at + 46 + name > directoryEnd){
+                break;
+            }
+            if((name > 4 && strncasecmp((const char *)data + at + 46 + name - 4, ".nes", 4) == 0) || entries == 1){
+                chosen = data + at;
+                break;
+            }
+            at += 46 + name + littleEndian16(data + at + 30) + littleEndian16(data + at + 32);
+        }
+        if(chosen == NULL){
+            if(this->verbose){
+                std::cout<<"no .nes entry in the zip archive"<<std::endl;
+            }
+            return -1;
+        }
+        uint16_t method = littleEndian16(chosen + 10);
+        uint32_t crc    = littleEndian32(chosen + 16);
+        size_t packed   = littleEndian32(chosen + 20);
+        size_t unpacked = littleEndian32(chosen + 24);
+        size_t local    = littleEndian32(chosen + 42);
+        if(local + 30 > size || littleEndian32(data + local) != 0x04034B50){
+            return -1;
+        }
+        size_t begin = local + 30 + littleEndian16(data + local + 26) + littleEndian16(data + local + 28);
+        if(begin > size || packed > size - begin){
+            return -1;
+        }
+        if(method == 0){
+            // STORED: THE IMAGE IS RIGHT THERE IN THE MAPPED FILE.
+            this->image     = data + begin;
+            this->imageSize = packed;
+            return this->parse();
+        }
+        if(method != 8){
+            if(this->verbose){
+                std::cout<<"zip compression method "<<method<<" is not supported"<<std::endl;
+            }
+            return -1;
+        }
+        // RAW DEFLATE: NO WRAPPER, SO THE CRC IS CHECKED HERE.
+        return this->inflateImage(data + begin, packed, unpacked, -15, &crc);
+    }
+
+#ifdef HAVE_ZLIB
+    // INFLATE UNTIL size BYTES ARE OUT, THE STREAM ENDS OR IT FAILS (status).
+    static size_t inflateSome(z_stream &stream, mos6502::i8 *out, size_t size, int &status){
+        stream.next_out  = out;
+        stream.avail_out = size;
+        while(stream.avail_out > 0 && status == Z_OK){
+            status = inflate(&stream, Z_NO_FLUSH);
+        }
+        return size - stream.avail_out;
+    }
+#endif
+
+    mos6502::i8 ROM::inflateImage(const mos6502::i8 *data, size_t size, size_t expected, int windowBits, const uint32_t *crc){
+#ifdef HAVE_ZLIB
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if(size > UINT_MAX || inflateInit2(&stream, windowBits) != Z_OK){
+            return -1;
+        }
+        stream.next_in  = const_cast<mos6502::i8 *>(data);
+        stream.avail_in = size;
+        int status = Z_OK;
+
+        // THE HEADER SAYS HOW BIG THE IMAGE IS, SO owned IS ALLOCATED ONCE AND
+        // THE BANKS INFLATE STRAIGHT INTO IT.
+        mos6502::i8 header[16];
+        size_t got = inflateSome(stream, header, sizeof(header), status);
+        size_t total = got;
+        size_t prgBanks, chrBanks;
+        if(got == sizeof(header) && header[0] == 'N' && header[1] == 'E' && header[2] == 'S' && header[3] == 0x1A
+           && countBanks(header, prgBanks, chrBanks)){
+            total = 16 + ((header[6] & 0x04) ? 512 : 0) + prgBanks * PRG_BANK_SIZE + chrBanks * CHR_BANK_SIZE;
+        }
+        // A FORGED HEADER MUST NOT BUY A BIG ALLOCATION: NO MORE THAN THE ARCHIVE
+        // SAYS THE IMAGE IS, NOR THAN size BYTES OF DEFLATE CAN HOLD (UNDER
+        // 1032 TO 1). A SHORT IMAGE THEN FAILS parse() LIKE A TRUNCATED FILE.
+        total = std::max(got, std::min(total, std::min(expected, size * 1032)));
+        this->owned.reset(new mos6502::i8[total]);
+        memcpy(this->owned.get(), header, got);
+        got += inflateSome(stream, this->owned.get() + got, total - got, status);
+
+        // WHATEVER FOLLOWS THE BANKS (PLAYCHOICE DATA, USUALLY NOTHING) IS
+        // ONLY INFLATED TO REACH THE END, WHERE THE CRC IS.
+        uLong sum = crc ? ::crc32(0L, this->owned.get(), got) : 0;
+        mos6502::i8 rest[4096];
+        while(status == Z_OK){
+            size_t n = inflateSome(stream, rest, sizeof(rest), status);
+            if(crc){
+                sum = ::crc32(sum, rest, n);
+            }
+        }
+        inflateEnd(&stream);
+        if(status != Z_STREAM_END || (crc && sum != *crc)){
+            if(this->verbose){
+                std::cout<<"compressed image is corrupt"<<std::endl;
+            }
+            this->owned.reset();
+            return -1;
+        }
+        this->image     = this->owned.get();
+        this->imageSize = got;
+        return this->parse();
+#else
+        if(this->verbose){
+            std::cout<<"compressed images need zlib"<<std::endl;
+        }
+        return -1;
+#endif
+    }
+
+    mos6502::i8 ROM::parse(){
+        const mos6502::i8 *prog = this->image;
+        size_t size = this->imageSize;
+        if(size < 16 || prog[0] != 'N' || prog[1] != 'E' || prog[2] != 'S' || prog[3] != 0x1A){
+            if(this->verbose){
+                std::cout<<"not an iNES image ("<<size<<" bytes)"<<std::endl;
+            }
+            return -1;
+        }
 
         for(int i = 0; i <16; i++){
             this->header[i] = prog[i];
@@ -132,24 +600,43 @@ namespace rom{
             this->trainer    = (this->f6 & (0x1 << 0x2)) >> 0x2; // & 0b00000100 >> 2
             this->fourScreen = (this->f6 & (0x1 << 0x3)) >> 0x3; // & 0b00001000 >> 3
             this->mapperType = (this->f6 & 0xF0) >> 0x4;         // & 0b11110000 >> 4
-            this->mapperType |= (this->f7 >> 0x4);
-            /*
-            mos6502::i8 err = 0;
-            for(int i=8; i<16; i++){
-                if(this->header[i]!=0){
-                    err = 0x1;
-                }
+
+        bool nes2 = (this->f7 & 0x0C) == 0x08;
+        this->nes2 = nes2;
+        size_t prgBanks, chrBanks;
+        if(!countBanks(this->header, prgBanks, chrBanks)){
+            if(this->verbose){
+                std::cout<<"NES 2.0 exponent bank sizes are not supported"<<std::endl;
             }
-            if(err==0x1){
-                this->mapperType &= 0xF;
+            return -1;
+        }
+
+        // ARCHAIC iNES: RIPPERS LEFT THEIR NAME IN BYTES 7-15 ("DiskDude!"), SO
+        // WITH THE LAST FOUR BYTES NOT ZERO THE UPPER MAPPER NIBBLE IS JUNK.
+        if(nes2 || (this->fc | this->fd | this->fe | this->ff) == 0){
+            this->mapperType |= (this->f7 & 0xF0);
+        }
+
+        // THE HEADER, THE TRAINER AND EVERY BANK IT ANNOUNCES MUST BE THERE.
+        this->prgOffset = 16 + (this->trainer ? 512 : 0);
+        this->chrOffset = this->prgOffset + prgBanks * PRG_BANK_SIZE;
+        if(prgBanks == 0 || size < this->chrOffset + chrBanks * CHR_BANK_SIZE){
+            if(this->verbose){
+                std::cout<<"not an iNES image ("<<size<<" bytes)"<<std::endl;
             }
-            */
+            return -1;
+        }
+        this->prgBanks = prgBanks;
+        this->chrBanks = chrBanks;
+        if(!this->verbose){
+            return 0;
+        }
 
-        std::cout<<"SIZE:"<<prog.size();
+        std::cout<<"SIZE:"<<size;
         std::cout<<std::endl;
-        std::cout<<"CONSTANT:"<<(char*)this->constant;
-        std::cout<<" PRGROMSIZE:"<<((0xff) & this->sizeOfPRGROM);
-        std::cout<<" CHRROMSIZE:"<<((0xff) & this->sizeOfCHRROM);
+        std::cout<<"CONSTANT:"<<(nes2 ? "NES 2.0" : "NES");
+        std::cout<<" PRGROMSIZE:"<<this->prgBanks;
+        std::cout<<" CHRROMSIZE:"<<this->chrBanks;
         std::cout<<std::endl;
         std::cout<<"FLAG6:("<<((0xff)   & this->f6)<<")"<<std::bitset<8>(0xFF & this->f6);
         std::cout<<" FLAG7:("<<((0xff)  & this->f7)<<")"<<std::bitset<8>(0xFF & this->f7);
@@ -163,36 +650,13 @@ namespace rom{
         std::cout<<" FLAG14:"<<((0xff)  & this->fe);
         std::cout<<" FLAG15:"<<((0xff)  & this->ff);
         std::cout<<std::endl;
-        std::cout<<"MAPPER_TYPE:"<<(this->mapperNames[this->mapperType]);
+        std::cout<<"MAPPER_TYPE:"<<(this->mapperType < this->mapperNames.size() ? this->mapperNames[this->mapperType] : "Unknown Mapper");
         std::cout<<std::endl;
 
-        mos6502::i16 PRGROM_BANK_SIZE = 16 * 1024;
-        for(int i = 0; i < this->sizeOfPRGROM; i++){
-            std::vector<mos6502::i8> PRGROM_BANK(PRGROM_BANK_SIZE,0xFF);
-            for(int j = 0; j < PRGROM_BANK_SIZE; j++){
-                PRGROM_BANK[j] = (0xFF & prog[16 + i*PRGROM_BANK_SIZE + j]);
-            }
-            this->PRGROM.push_back(PRGROM_BANK);
-        }
-
-        if(this->sizeOfCHRROM > 0){
-            mos6502::i16 CHRROM_BANK_SIZE = 8 * 1024;
-            for(int i = 0; i < this->sizeOfCHRROM; i++){
-                std::vector<mos6502::i8> CHRROM_BANK(CHRROM_BANK_SIZE,0xFF);
-                for(int j = 0; j < CHRROM_BANK_SIZE; j++){
-                    CHRROM_BANK[j] = prog[16 + this->sizeOfPRGROM*PRGROM_BANK_SIZE + i*CHRROM_BANK_SIZE + j];
-                }
-                this->CHRROM.push_back(CHRROM_BANK);
-            }
-        }
-
-
-
-
-
+        return 0;
     }
 
     ROM::~ROM(){
-    
+        this->unload();
     }
 };
@@ -0,0 +1,206 @@
+#include "../include/RUNNER.h"
+#include "../include/CPU.h"
+#include "../include/ROM.h"
+#include "../include/MAPPER.h"
+#include "../include/REWIND.h"
+#include "../include/MOVIE.h"
+#include "../include/joypads.h"
+#include <thread>
+#include <chrono>
+#include <sstream>
+#include <string.h>
+#ifdef LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace runner{
+
+    bool parseJobs(std::istream &in, std::vector<Job> &jobs, std::string &error){
+        std::string line;
+        int number = 0;
+        while(std::getline(in, line)){
+            number++;
+            size_t hash = line.find('#');
+            if(hash != std::string::npos){
+                line.erase(hash);
+            }
+            std::istringstream fields(line);
+            Job job;
+            long frames = 0;
+            if(!(fields>>job.rom)){
+                continue;
+            }
+            if(!(fields>>frames) || frames <= 0){
+                error = "line " + std::to_string(number) + ": expected <rom> <frames> [movie]";
+                return false;
+            }
+            job.frames = (uint32_t)frames;
+            fields>>job.movie;
+            jobs.push_back(job);
+        }
+        return true;
+    }
+
+    Runner::Runner(const Options &options) : options(options){
+        this->workers = options.threads;
+        if(this->workers <= 0){
+            this->workers = std::thread::hardware_concurrency();
+        }
+        if(this->workers <= 0){
+            this->workers = 1;
+        }
+        this->queues.reset(new Queue[this->workers]);
+    }
+
+    // OWN DEQUE FIRST (NEWEST JOB), THEN STEAL THE OLDEST JOB OF THE NEXT
+    // WORKERS IN TURN. JOBS ARE ONLY EVER REMOVED, SO ONE EMPTY SWEEP MEANS
+    // THERE IS NOTHING LEFT.
+    bool Runner::take(int worker, size_t &job){
+        for(int i = 0; i < this->workers; i++){
+            Queue &queue = this->queues[(worker + i) % this->workers];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if(queue.jobs.empty()){
+                continue;
+            }
+            if(i == 0){
+                job = queue.jobs.back();
+                queue.jobs.pop_back();
+            }else{
+                job = queue.jobs.front();
+                queue.jobs.pop_front();
+                this->stats[worker].steals++;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    std::shared_ptr<Image> Runner::image(const std::string &path){
+        Slot *slot;
+        {
+            std::lock_guard<std::mutex> lock(this->imagesMutex);
+            std::unique_ptr<Slot> &entry = this->images[path];
+            if(!entry){
+                entry.reset(new Slot());
+            }
+            slot = entry.get();
+        }
+        std::call_once(slot->once, [slot, &path](){
+            std::shared_ptr<Image> image(new Image());
+            image->loaded = false;
+            image->crc = 0;
+            if(image->rom.loadNesFile(path.c_str()) == 0 && image->rom.getPRGBanks() > 0){
+                image->crc = image->rom.getCRC32();
+                image->loaded = true;
+            }
+            slot->image = image;
+        });
+        return slot->image;
+    }
+
+    void Runner::runJob(int worker, size_t index){
+        const Job &job = this->jobs[index];
+        Result &result = this->results[index];
+        result.worker = worker;
+
+        std::shared_ptr<Image> image = this->image(job.rom);
+        if(!image->loaded){
+            return;
+        }
+        std::unique_ptr<movie::Movie> movie;
+        if(!job.movie.empty()){
+            movie.reset(new movie::Movie());
+            if(movie->load(job.movie.c_str()) != 0 || movie->getRomCRC() != image->crc){
+                return;
+            }
+        }
+
+        std::unique_ptr<cpu::CPU> cpu(new cpu::CPU());
+        cpu->reset();
+        std::unique_ptr<mapper::Mapper> cart(mapper::create(image->rom, *cpu));
+        cart->reset();
+        cpu->readResetVector();
+        nes::JoyPads pads(cpu->getBus(), cpu->getPads());
+        cpu->setJit(this->options.jit);
+        cpu->setIdleSkip(this->options.idleSkip);
+        std::unique_ptr<history::Buffer> rewind;
+        if(this->options.rewind){
+            rewind.reset(new history::Buffer(this->options.rewind));
+        }
+
+        uint64_t start = cpu->getCycles();
+        std::chrono::steady_clock::time_point clock = std::chrono::steady_clock::now();
+        for(uint32_t frame = 0; frame < job.frames; frame++){
+            if(movie && frame < movie->getFrames()){
+                if(movie->isKeyframe(frame)){
+                    result.keyframes++;
+                    if(!movie->matches(frame, cpu->getState())){
+                        result.desyncs++;
+                    }
+                }
+                pads.set(0, movie->getInput(frame, 0));
+                pads.set(1, movie->getInput(frame, 1));
+            }
+            cpu->runFrame();
+            if(rewind){
+                rewind->push(cpu->getState());
+            }
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - clock).count();
+        result.frames  = job.frames;
+        result.cycles  = cpu->getCycles() - start;
+        result.pc      = cpu->getPC();
+        result.rewindFrames = rewind ? rewind->getFrames() : 0;
+
+        WorkerStats &stats = this->stats[worker];
+        stats.jobs++;
+        stats.frames  += result.frames;
+        stats.cycles  += result.cycles;
+        stats.seconds += result.seconds;
+    }
+
+    void Runner::work(int worker){
+#ifdef LINUX
+        if(this->options.pin){
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(worker % CPU_SETSIZE, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+#endif
+        size_t job;
+        while(this->take(worker, job)){
+            this->runJob(worker, job);
+        }
+    }
+
+    const std::vector<Result> &Runner::run(const std::vector<Job> &jobs){
+        this->jobs = jobs;
+        Result empty = {0, 0, 0.0, -1, 0, 0, 0, 0};
+        this->results.assign(jobs.size(), empty);
+        WorkerStats zero;
+        memset(&zero, 0, sizeof(zero));
+        this->stats.assign(this->workers, zero);
+
+        // DEAL THE JOBS OUT ROUND ROBIN, STEALING EVENS OUT THE REST.
+        for(size_t i = 0; i < jobs.size(); i++){
+            this->queues[i % this->workers].jobs.push_back(i);
+        }
+
+        std::vector<std::thread> threads;
+        for(int i = 1; i < this->workers; i++){
+            threads.push_back(std::thread(&Runner::work, this, i));
+        }
+        this->work(0);
+        for(size_t i = 0; i < threads.size(); i++){
+            threads[i].join();
+        }
+        return this->results;
+    }
+
+    Runner::~Runner(){
+
+    }
+
+};
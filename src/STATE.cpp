@@ -0,0 +1,44 @@
+#include "../include/STATE.h"
+#include <fstream>
+#include <iostream>
+#include <string.h>
+
+namespace state{
+
+    int saveFile(const char *path, const Machine &machine){
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if(!file){
+            std::cout<<"file '"<<path<<"' open filed"<<std::endl;
+            return -1;
+        }
+        Header header = {MAGIC, VERSION, (uint32_t)sizeof(Machine), 0};
+        file.write((const char *)&header, sizeof(header));
+        file.write((const char *)&machine, sizeof(machine));
+        return file ? 0 : -1;
+    }
+
+    // READ INTO A SCRATCH COPY FIRST SO A SHORT OR FOREIGN FILE LEAVES
+    // machine AS IT WAS.
+    int loadFile(const char *path, Machine &machine){
+        std::ifstream file(path, std::ios::binary);
+        if(!file){
+            std::cout<<"file '"<<path<<"' open filed"<<std::endl;
+            return -1;
+        }
+        Header header;
+        if(!file.read((char *)&header, sizeof(header))){
+            return -1;
+        }
+        if(header.magic != MAGIC || header.version != VERSION || header.size != sizeof(Machine)){
+            std::cout<<"file '"<<path<<"' is not a version "<<VERSION<<" savestate"<<std::endl;
+            return -1;
+        }
+        Machine scratch;
+        if(!file.read((char *)&scratch, sizeof(scratch))){
+            return -1;
+        }
+        memcpy(&machine, &scratch, sizeof(machine));
+        return 0;
+    }
+
+};
@@ -0,0 +1,215 @@
+#include "../include/TRACE.h"
+#include "../include/CPU.h"
+#include <fstream>
+#include <algorithm>
+#include <stdio.h>
+
+namespace trace{
+
+    void format(const Record &record, std::ostream &out){
+        const cpu::CPU::OpINS &ins = cpu::CPU::opTable[record.op];
+        char operand[8] = "";
+        if(ins.bytes == 2){
+            snprintf(operand, sizeof(operand), "%02X", record.operand & 0xFF);
+        }else if(ins.bytes == 3){
+            snprintf(operand, sizeof(operand), "%04X", record.operand);
+        }
+
+        char line[96];
+        snprintf(line, sizeof(line), "PC:%04X OP:%02X %s %-4s A:%02X X:%02X Y:%02X P:%02X SP:%02X CYC:%llu\n",
+                 record.pc, record.op, cpu::CPU::opNames[record.op], operand,
+                 record.A, record.X, record.Y, record.P, record.SP,
+                 (unsigned long long)record.cycle);
+        out<<line;
+    }
+
+    bool formatFile(const char *file, std::ostream &out){
+        std::ifstream in(file, std::ios::binary);
+        if(!in){
+            std::cout<<"file '"<<file<<"' open filed"<<std::endl;
+            return false;
+        }
+        Record record;
+        while(in.read((char *)&record, sizeof(Record))){
+            format(record, out);
+        }
+        return true;
+    }
+
+
+    BinaryTrace::BinaryTrace(uint64_t capacity){
+        uint64_t size = 1;
+        while(size < capacity){
+            size <<= 1;
+        }
+        this->ring.resize(size);
+        this->mask = size - 1;
+    }
+
+    uint64_t BinaryTrace::size() const{
+        return this->head < this->ring.size() ? this->head : this->ring.size();
+    }
+
+    const Record &BinaryTrace::at(uint64_t index) const{
+        return this->ring[(this->head - this->size() + index) & this->mask];
+    }
+
+    void BinaryTrace::flush(std::ostream &out){
+        for(uint64_t i = 0; i < this->size(); i++){
+            out.write((const char *)&this->at(i), sizeof(Record));
+        }
+        this->clear();
+    }
+
+    void BinaryTrace::format(std::ostream &out) const{
+        for(uint64_t i = 0; i < this->size(); i++){
+            trace::format(this->at(i), out);
+        }
+    }
+
+    void BinaryTrace::clear(){
+        this->head = 0;
+    }
+
+
+    void TextTrace::record(mos6502::i16 pc, mos6502::i8 op, mos6502::i16 operand,
+                           mos6502::i8 A, mos6502::i8 X, mos6502::i8 Y,
+                           mos6502::i8 P, mos6502::i8 SP, uint64_t cycle){
+        Record r = {cycle, pc, operand, op, A, X, Y, P, SP, {0}};
+        trace::format(r, this->out);
+    }
+
+
+
+    const uint16_t Profile::IDENTITY[4] = {0, 1, 2, 3};
+
+    Profile::Profile(const uint16_t *banks, uint32_t prgBanks) : ops(OPS + 1){
+        this->banks     = banks ? banks : IDENTITY;
+        this->locations = PRG + std::max(prgBanks, 4u) * BANK_SIZE;
+        this->pcs.resize(this->locations + 1);
+        this->clear();
+    }
+
+    void Profile::finish(uint64_t cycle){
+        this->ops[this->lastOp].cycles += cycle - this->lastCycle;
+        this->pcs[this->lastPC].cycles += cycle - this->lastCycle;
+        this->lastOp    = OPS;
+        this->lastPC    = this->locations;
+        this->lastCycle = cycle;
+    }
+
+    void Profile::clear(){
+        std::fill(this->ops.begin(), this->ops.end(), Counter());
+        std::fill(this->pcs.begin(), this->pcs.end(), Counter());
+        this->lastOp    = OPS;
+        this->lastPC    = this->locations;
+        this->lastCycle = 0;
+    }
+
+    // INDICES OF THE top COUNTERS WITH THE MOST CYCLES, HOTTEST FIRST.
+    static std::vector<uint32_t> hottest(const std::vector<Profile::Counter> &counters, uint32_t size, int top){
+        std::vector<uint32_t> order;
+        for(uint32_t i = 0; i < size; i++){
+            if(counters[i].executions){
+                order.push_back(i);
+            }
+        }
+        size_t n = std::min(order.size(), (size_t)(top > 0 ? top : 0));
+        std::partial_sort(order.begin(), order.begin() + n, order.end(),
+                          [&counters](uint32_t a, uint32_t b){return counters[a].cycles > counters[b].cycles;});
+        order.resize(n);
+        return order;
+    }
+
+    void Profile::report(std::ostream &out, int top) const{
+        uint64_t executions = 0, cycles = 0;
+        for(uint32_t i = 0; i < OPS; i++){
+            executions += this->ops[i].executions;
+            cycles     += this->ops[i].cycles;
+        }
+        char line[128];
+        snprintf(line, sizeof(line), "%llu instructions, %llu cycles\n",
+                 (unsigned long long)executions, (unsigned long long)cycles);
+        out<<line;
+        double total = cycles ? cycles : 1;
+
+        out<<"\nOPCODES BY CYCLES\n    %CYC       CYCLES   EXECUTIONS  CYC/EX  OP\n";
+        std::vector<uint32_t> order = hottest(this->ops, OPS, top);
+        for(size_t i = 0; i < order.size(); i++){
+            const Counter &c = this->ops[order[i]];
+            snprintf(line, sizeof(line), "  %6.2f %12llu %12llu %7.2f  %02X %s\n",
+                     c.cycles * 100 / total, (unsigned long long)c.cycles, (unsigned long long)c.executions,
+                     (double)c.cycles / c.executions, order[i], cpu::CPU::opNames[order[i]]);
+            out<<line;
+        }
+
+        out<<"\nLOCATIONS BY CYCLES\n    %CYC       CYCLES   EXECUTIONS  CYC/EX  WHERE\n";
+        order = hottest(this->pcs, this->locations, top);
+        for(size_t i = 0; i < order.size(); i++){
+            const Counter &c = this->pcs[order[i]];
+            uint32_t location = order[i];
+            char where[24];
+            if(location >= PRG){
+                snprintf(where, sizeof(where), "PRG%03u:%04X", (location - PRG) / BANK_SIZE, location % BANK_SIZE);
+            }else if(location < 0x2000){
+                snprintf(where, sizeof(where), "RAM:%03X", location & 0x7FF);
+            }else{
+                snprintf(where, sizeof(where), "$%04X", location);
+            }
+            snprintf(line, sizeof(line), "  %6.2f %12llu %12llu %7.2f  %s\n",
+                     c.cycles * 100 / total, (unsigned long long)c.cycles, (unsigned long long)c.executions,
+                     (double)c.cycles / c.executions, where);
+            out<<line;
+        }
+
+        // THE SAME COUNTERS SUMMED PER 8 KB PRG BANK.
+        uint32_t prgBanks = (this->locations - PRG) / BANK_SIZE;
+        std::vector<Counter> banks(prgBanks);
+        for(uint32_t location = PRG; location < this->locations; location++){
+            Counter &bank = banks[(location - PRG) / BANK_SIZE];
+            bank.executions += this->pcs[location].executions;
+            bank.cycles     += this->pcs[location].cycles;
+        }
+        out<<"\nPRG BANKS BY CYCLES\n    %CYC       CYCLES   EXECUTIONS  CYC/EX  BANK\n";
+        order = hottest(banks, prgBanks, top);
+        for(size_t i = 0; i < order.size(); i++){
+            const Counter &c = banks[order[i]];
+            snprintf(line, sizeof(line), "  %6.2f %12llu %12llu %7.2f  PRG%03u\n",
+                     c.cycles * 100 / total, (unsigned long long)c.cycles, (unsigned long long)c.executions,
+                     (double)c.cycles / c.executions, order[i]);
+            out<<line;
+        }
+    }
+
+    // LOG2 IN EIGHTHS (THE BIT LENGTH AND THE THREE BITS BELOW THE TOP ONE), SO
+    // THE HEATMAP NEEDS NO libm.
+    static uint32_t logScale(uint64_t value){
+        uint32_t bits = 0;
+        while(bits < 64 && value >> bits){
+            bits++;
+        }
+        uint32_t fraction = bits > 3 ? (value >> (bits - 4)) & 7 : (value << (4 - bits)) & 7;
+        return bits ? bits * 8 + fraction : 0;
+    }
+
+    bool Profile::heatmap(const char *file) const{
+        std::ofstream out(file, std::ios::binary | std::ios::trunc);
+        if(!out){
+            std::cout<<"file '"<<file<<"' open filed"<<std::endl;
+            return false;
+        }
+        uint64_t most = 0;
+        for(uint32_t i = 0; i < this->locations; i++){
+            most = std::max(most, this->pcs[i].cycles);
+        }
+        uint32_t top = logScale(most);
+        std::vector<char> pixels(this->locations);
+        for(uint32_t i = 0; i < this->locations; i++){
+            pixels[i] = top ? (char)(logScale(this->pcs[i].cycles) * 255 / top) : 0;
+        }
+        out<<"P5\n256 "<<this->locations / 256<<"\n255\n";
+        out.write(&pixels[0], this->locations);
+        return true;
+    }
+
+};
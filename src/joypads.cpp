@@ -0,0 +1,50 @@
+#include "../include/joypads.h"
+
+namespace nes{
+
+    JoyPads::JoyPads(bus::Bus &bus, state::Pads &pads) : bus(&bus), pads(&pads){
+        this->bus->mapHandler(0x4000, 0x40FF, &JoyPads::read, &JoyPads::write, this);
+    }
+
+    void JoyPads::set(int port, mos6502::i8 buttons){
+        this->pads->buttons[port & 1] = buttons;
+        if(this->pads->strobe){
+            this->pads->shift[port & 1] = buttons;
+        }
+    }
+
+    mos6502::i8 JoyPads::read(void *context, mos6502::i16 addr){
+        JoyPads *joypads = (JoyPads *)context;
+        if(addr != 0x4016 && addr != 0x4017){
+            return bus::Bus::readIOLatch(joypads->bus, addr);
+        }
+        state::Pads &pads = *joypads->pads;
+        int port = addr & 1;
+        if(pads.strobe){
+            pads.shift[port] = pads.buttons[port];
+        }
+        mos6502::i8 bit = pads.shift[port] & 1;
+        // SHIFT IN 1S, SO THE NINTH READ ON RETURNS 1 LIKE AN OFFICIAL PAD.
+        pads.shift[port] = (pads.shift[port] >> 1) | 0x80;
+        return (addr >> 8) | bit;
+    }
+
+    void JoyPads::write(void *context, mos6502::i16 addr, mos6502::i8 data){
+        JoyPads *joypads = (JoyPads *)context;
+        if(addr != 0x4016){
+            bus::Bus::writeIOLatch(joypads->bus, addr, data);
+            return;
+        }
+        state::Pads &pads = *joypads->pads;
+        pads.strobe = data & 1;
+        if(pads.strobe){
+            pads.shift[0] = pads.buttons[0];
+            pads.shift[1] = pads.buttons[1];
+        }
+    }
+
+    // THE BUS MAY OUTLIVE US: HAND THE IO PAGE BACK TO ITS LATCHES.
+    JoyPads::~JoyPads(){
+        this->bus->mapHandler(0x4000, 0x40FF, &bus::Bus::readIOLatch, &bus::Bus::writeIOLatch, this->bus);
+    }
+};
@@ -0,0 +1,83 @@
+#include "../include/nerones.h"
+#include "../include/NES.h"
+#include <new>
+
+// THE HANDLE IS THE MACHINE ITSELF; THE C SIDE NEVER SEES INSIDE IT.
+struct nerones : public nes::NES{
+};
+
+static_assert(NERONES_WIDTH == nes::NES::WIDTH && NERONES_HEIGHT == nes::NES::HEIGHT, "framebuffer size");
+static_assert(NERONES_RAM_SIZE == sizeof(((state::Memory *)0)->ram), "ram size");
+static_assert(sizeof(mos6502::i8) == sizeof(uint8_t), "byte size");
+
+uint32_t nerones_api_version(void){
+    return NERONES_API_VERSION;
+}
+
+nerones *nerones_create(void){
+    try{
+        return new nerones();
+    }catch(...){
+        return NULL;
+    }
+}
+
+void nerones_destroy(nerones *nes){
+    delete nes;
+}
+
+int nerones_load_file(nerones *nes, const char *path){
+    try{
+        return nes->loadRom(path);
+    }catch(...){
+        return -1;
+    }
+}
+
+int nerones_load_memory(nerones *nes, const uint8_t *data, size_t size){
+    try{
+        return nes->loadRom(data, size);
+    }catch(...){
+        return -1;
+    }
+}
+
+int nerones_reset(nerones *nes){
+    return nes->reset();
+}
+
+int nerones_open_save(nerones *nes, const char *path){
+    try{
+        return nes->openSave(path);
+    }catch(...){
+        return -1;
+    }
+}
+
+uint64_t nerones_step(nerones *nes, const uint8_t *inputs, uint32_t frames){
+    uint64_t cycles = 0;
+    for(uint32_t i = 0; i < frames; i++){
+        if(inputs != NULL){
+            nes->setInput(0, inputs[2 * i]);
+            nes->setInput(1, inputs[2 * i + 1]);
+        }
+        cycles += nes->stepFrame();
+    }
+    return cycles;
+}
+
+const uint8_t *nerones_framebuffer(nerones *nes){
+    return nes->framebuffer();
+}
+
+const uint32_t *nerones_palette(void){
+    return ppu::PALETTE;
+}
+
+const uint8_t *nerones_ram(nerones *nes){
+    return nes->ram();
+}
+
+void nerones_poke(nerones *nes, uint16_t addr, uint8_t value){
+    nes->poke(addr, value);
+}
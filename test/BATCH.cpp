@@ -0,0 +1,107 @@
+#include "../include/RUNNER.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string.h>
+#include <stdlib.h>
+
+// HEADLESS BATCH RUNNER.
+//
+// RUNS EVERY JOB OF A JOB FILE (ONE "<rom> <frames> [movie]" PER LINE, SEE
+// RUNNER.h) ACROSS THE WORKER POOL, THEN PRINTS ONE LINE PER JOB, ONE LINE PER
+// WORKER WITH ITS FRAMES PER SECOND, AND THE TOTAL.
+//
+//   NES_BATCH [-t threads] [-j] [-n] [-p] [-r KB] <jobs file | ->
+//     -t  WORKER THREADS, DEFAULT ONE PER HARDWARE THREAD
+//     -j  JIT TIER ON
+//     -n  NO IDLE LOOP SKIPPING
+//     -p  PIN WORKER i TO CPU i
+//     -r  KEEP KB KILOBYTES OF REWIND HISTORY PER JOB
+
+static int usage(const char *name){
+    std::cout<<"Usage: "<<name<<" [-t threads] [-j] [-n] [-p] [-r KB] <jobs file | ->"<<std::endl;
+    return -1;
+}
+
+int main(int argc, char *argv[]){
+    runner::Options options = {0, false, true, false, 0};
+    const char *file = NULL;
+    for(int i = 1; i < argc; i++){
+        if(!strcmp(argv[i], "-t") && i + 1 < argc){
+            options.threads = atoi(argv[++i]);
+        }else if(!strcmp(argv[i], "-j")){
+            options.jit = true;
+        }else if(!strcmp(argv[i], "-n")){
+            options.idleSkip = false;
+        }else if(!strcmp(argv[i], "-p")){
+            options.pin = true;
+        }else if(!strcmp(argv[i], "-r") && i + 1 < argc){
+            options.rewind = (size_t)atol(argv[++i]) * 1024;
+        }else if(!file){
+            file = argv[i];
+        }else{
+            return usage(argv[0]);
+        }
+    }
+    if(!file){
+        return usage(argv[0]);
+    }
+
+    std::vector<runner::Job> jobs;
+    std::string error;
+    bool parsed;
+    if(!strcmp(file, "-")){
+        parsed = runner::parseJobs(std::cin, jobs, error);
+    }else{
+        std::ifstream in(file);
+        if(!in){
+            std::cout<<"file '"<<file<<"' open filed"<<std::endl;
+            return -1;
+        }
+        parsed = runner::parseJobs(in, jobs, error);
+    }
+    if(!parsed){
+        std::cout<<file<<": "<<error<<std::endl;
+        return -1;
+    }
+
+    runner::Runner batch(options);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const std::vector<runner::Result> &results = batch.run(jobs);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int failed = 0;
+    for(size_t i = 0; i < results.size(); i++){
+        const runner::Result &result = results[i];
+        if(!result.frames){
+            std::cout<<"job "<<i<<" "<<jobs[i].rom<<": failed to load (rom, or movie not recorded on it)"<<std::endl;
+            failed++;
+            continue;
+        }
+        std::cout<<"job "<<i<<" "<<jobs[i].rom<<": "<<result.frames<<" frames, "<<result.cycles<<" cycles, "
+                 <<(long)(result.frames / result.seconds)<<" frames/s on worker "<<result.worker
+                 <<", PC "<<std::hex<<result.pc<<std::dec;
+        if(options.rewind){
+            std::cout<<", "<<result.rewindFrames<<" frames of rewind";
+        }
+        if(result.keyframes){
+            std::cout<<", "<<result.keyframes<<" keyframes checked, "<<result.desyncs<<" desynced";
+            failed += result.desyncs ? 1 : 0;
+        }
+        std::cout<<std::endl;
+    }
+
+    uint64_t frames = 0;
+    const std::vector<runner::WorkerStats> &stats = batch.getStats();
+    for(size_t i = 0; i < stats.size(); i++){
+        const runner::WorkerStats &worker = stats[i];
+        frames += worker.frames;
+        std::cout<<"worker "<<i<<": "<<worker.jobs<<" jobs ("<<worker.steals<<" stolen), "<<worker.frames<<" frames, "
+                 <<(long)(worker.seconds > 0 ? worker.frames / worker.seconds : 0)<<" frames/s"<<std::endl;
+    }
+    std::cout<<"total: "<<jobs.size()<<" jobs, "<<batch.getImages()<<" roms, "<<batch.getWorkers()<<" workers, "
+             <<frames<<" frames in "<<wall<<" s, "<<(long)(frames / wall)<<" frames/s, "
+             <<(long)(frames / wall / batch.getWorkers())<<" frames/s per core"<<std::endl;
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,197 @@
+#include "../include/CPU.h"
+#include "../include/ROM.h"
+#include "../include/LOCKSTEP.h"
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <chrono>
+
+// OPCODE DISPATCH BENCHMARK.
+//
+// RUNS EACH ROM IN game_rom/ THROUGH CPU::step() AND REPORTS INSTRUCTIONS PER
+// SECOND, RUNS THE SAME NUMBER OF CYCLES THROUGH THE THREADED runFrame() CORE,
+// THEN REPLAYS THE SAME OPCODE STREAM THROUGH THE OLD
+// std::map<i16,OpINS> + std::string LOOKUP AND THROUGH THE DENSE TABLE SO THE
+// DISPATCH COST CAN BE COMPARED BEFORE/AFTER. THE runFrame() RUN IS REPEATED
+// WITH THE JIT TIER ON AND WITH IDLE LOOP SKIPPING ON, WHICH IS OFF FOR THE
+// OTHER RUNS SO THEY MEASURE THE CORE. THE SAME FRAMES ARE THEN RUN ON LANES
+// COPIES IN THE LOCKSTEP ENGINE. SNAPSHOTS OF THE IDLE SKIP MACHINE ARE TAKEN
+// AND RESTORED SNAPSHOTS TIMES. BLOCK CACHE COUNTERS ARE THOSE
+// OF THE runFrame() RUN.
+
+static const char *roms[] = {
+    "game_rom/Super_mario_brothers.nes",
+    "game_rom/donkykong.nes",
+    "game_rom/zelda.nes",
+    "game_rom/nomolos.nes",
+};
+
+static const long STEPS = 20000000;
+static const int LANES  = 256;
+static const long SNAPSHOTS = 1000000;
+static const int SLOTS = 8;                 // SNAPSHOTS ROTATE THROUGH SLOTS BUFFERS
+
+// SHAPE OF THE DESCRIPTOR THE std::map TABLE USED TO HOLD.
+struct LegacyOpINS{
+    mos6502::i8 op;
+    mos6502::i8 addrMode;
+    std::string opName;
+    mos6502::i8 bytes;
+    mos6502::i8 cycles;
+    cpu::CPU::opHandler handler;
+    mos6502::i8 *value;
+};
+
+static double seconds(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]){
+    long steps = argc > 1 ? atol(argv[1]) : STEPS;
+
+    std::map<mos6502::i16,LegacyOpINS> legacyTable;
+    for(int i = 0; i < 256; i++){
+        const cpu::CPU::OpINS &ins = cpu::CPU::opTable[i];
+        LegacyOpINS legacy = {ins.op, ins.addrMode, cpu::CPU::opNames[i], ins.bytes, ins.cycles, ins.opHandler, 0};
+        legacyTable.insert(std::pair<mos6502::i16,LegacyOpINS>(i, legacy));
+    }
+
+    for(unsigned r = 0; r < sizeof(roms)/sizeof(roms[0]); r++){
+        rom::ROM rom;
+        if(rom.loadNesFile(roms[r]) != 0){
+            continue;
+        }
+        rom::Span first = rom.getPRG(0);
+        rom::Span last  = rom.getPRG(rom.getPRGBanks() - 1);
+
+        cpu::CPU cpu;
+        cpu.reset();
+        cpu.setPRG1(first.data, first.size);
+        cpu.setPRG2(last.data, last.size);
+        cpu.readResetVector();
+
+        // RECORD THE OPCODE STREAM WHILE TIMING THE INTERPRETER.
+        std::vector<mos6502::i8> trace;
+        trace.reserve(1 << 20);
+        uint64_t startCycles = cpu.getCycles();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(long i = 0; i < steps; i++){
+            cpu.step();
+            if(trace.size() < trace.capacity()){
+                trace.push_back(cpu.opINS->op);
+            }
+        }
+        double interp = seconds(start);
+        uint64_t stepCycles = cpu.getCycles() - startCycles;
+
+        cpu::CPU threaded;
+        threaded.reset();
+        threaded.setPRG1(first.data, first.size);
+        threaded.setPRG2(last.data, last.size);
+        threaded.readResetVector();
+        threaded.setIdleSkip(false);
+        uint64_t frameCycles = 0;
+        long frames = 0;
+        start = std::chrono::steady_clock::now();
+        while(frameCycles < stepCycles){
+            frameCycles += threaded.runFrame();
+            frames++;
+        }
+        double core = seconds(start);
+
+        // SAME AGAIN WITH THE NATIVE TIER, WHERE THE BUILD HAS ONE.
+        cpu::CPU native;
+        native.reset();
+        native.setPRG1(first.data, first.size);
+        native.setPRG2(last.data, last.size);
+        native.readResetVector();
+        native.setIdleSkip(false);
+        bool jit = native.setJit(true);
+        uint64_t jitCycles = 0;
+        start = std::chrono::steady_clock::now();
+        while(jitCycles < stepCycles){
+            jitCycles += native.runFrame();
+        }
+        double jitTime = seconds(start);
+
+        // SAME FRAMES WITH POLLING LOOPS FAST-FORWARDED.
+        cpu::CPU idle;
+        idle.reset();
+        idle.setPRG1(first.data, first.size);
+        idle.setPRG2(last.data, last.size);
+        idle.readResetVector();
+        start = std::chrono::steady_clock::now();
+        for(long i = 0; i < frames; i++){
+            idle.runFrame();
+        }
+        double idleTime = seconds(start);
+        uint64_t idleCycles = idle.getCycles() - startCycles;
+
+        // SAVE/LOAD ROUND TRIPS OF THE WHOLE MACHINE.
+        state::Machine slots[SLOTS];
+        start = std::chrono::steady_clock::now();
+        for(long i = 0; i < SNAPSHOTS; i++){
+            idle.saveState(slots[i % SLOTS]);
+        }
+        double saveTime = seconds(start);
+        start = std::chrono::steady_clock::now();
+        for(long i = 0; i < SNAPSHOTS; i++){
+            idle.loadState(slots[i % SLOTS]);
+        }
+        double loadTime = seconds(start);
+
+        // LANES MACHINES IN LOCKSTEP, EACH WITH ITS OWN INPUT BYTE.
+        mos6502::i8 window[0x8000];
+        memcpy(window, first.data, 0x4000);
+        memcpy(window + 0x4000, last.data, 0x4000);
+        lockstep::Engine lanes(LANES);
+        lanes.setPRG(window);
+        lanes.reset();
+        for(int l = 0; l < LANES; l++){
+            lanes.setInput(l, 0, l);
+        }
+        long laneFrames = frames / LANES + 1;
+        start = std::chrono::steady_clock::now();
+        for(long i = 0; i < laneFrames; i++){
+            lanes.runFrame();
+        }
+        double lockTime = seconds(start);
+        const lockstep::Stats &lockStats = lanes.getStats();
+
+        long lookups = 0;
+        mos6502::i16 sink = 0;
+        start = std::chrono::steady_clock::now();
+        for(long i = 0; i < steps; i++){
+            LegacyOpINS ins = legacyTable[trace[i % trace.size()]];
+            sink += ins.bytes + ins.opName.size();
+            lookups++;
+        }
+        double before = seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        for(long i = 0; i < steps; i++){
+            const cpu::CPU::OpINS *ins = &cpu::CPU::opTable[trace[i % trace.size()]];
+            sink += ins->bytes + ins->cycles;
+        }
+        double after = seconds(start);
+
+        std::cout<<roms[r]<<": "<<std::dec<<(long)(steps / interp)<<" instructions/s"
+                 <<", step() "<<(long)(stepCycles / interp)<<" cycles/s"
+                 <<", runFrame() "<<(long)(frameCycles / core)<<" cycles/s ("<<(long)(frames / core)<<" frames/s)"
+                 <<", jit "<<(jit ? (long)(jitCycles / jitTime) : 0)<<" cycles/s ("<<native.getJitStats().compiled<<" blocks)"
+                 <<", idle skip "<<(long)(frames / idleTime)<<" frames/s ("
+                 <<(idleCycles ? 100 * idle.getIdleStats().cycles / idleCycles : 0)<<"% cycles skipped)"
+                 <<", lockstep "<<(long)(laneFrames * LANES / lockTime)<<" frames/s ("<<LANES<<" lanes, "
+                 <<(100 * lockStats.vectorLanes / (lockStats.vectorLanes + lockStats.scalarLanes + 1))<<"% vector)"
+                 <<", savestate "<<(saveTime * 1e9 / SNAPSHOTS)<<" ns save/"<<(loadTime * 1e9 / SNAPSHOTS)<<" ns load ("
+                 <<sizeof(state::Machine)<<" bytes)"
+                 <<", map dispatch "<<(before * 1e9 / lookups)<<" ns/op"
+                 <<", table dispatch "<<(after * 1e9 / lookups)<<" ns/op"
+                 <<", blocks "<<threaded.getBlockStats().hits<<" hit/"<<threaded.getBlockStats().misses<<" miss/"
+                 <<threaded.getBlockStats().invalidations<<" invalidated"
+                 <<" ("<<(sink & 1)<<")"<<std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include "../include/BUS.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+
+// MEMORY ACCESS MICROBENCHMARK.
+//
+// READS THE SAME ADDRESS STREAMS THROUGH THE OLD FLAT 64 KB ARRAY (NO
+// MIRRORING), A BRANCH LADDER THAT DECODES THE NES MAP, AND THE PAGE TABLE
+// BUS, AND REPORTS NS PER ACCESS.
+
+static const long ACCESSES = 50000000;
+
+static mos6502::i8 ram[0x800];
+static mos6502::i8 sram[0x2000];
+static mos6502::i8 prg[0x8000];
+static mos6502::i8 ppu[0x8];
+static mos6502::i8 io[0x20];
+
+static mos6502::i8 ladderRead(mos6502::i16 addr){
+    if(addr < 0x2000){
+        return ram[addr & 0x7FF];
+    }else if(addr < 0x4000){
+        return ppu[addr & 0x7];
+    }else if(addr < 0x4020){
+        return io[addr & 0x1F];
+    }else if(addr < 0x6000){
+        return addr >> 8;
+    }else if(addr < 0x8000){
+        return sram[addr & 0x1FFF];
+    }
+    return prg[addr & 0x7FFF];
+}
+
+static double seconds(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::vector<mos6502::i16> stream(int ramPercent, int prgPercent){
+    std::vector<mos6502::i16> addrs(1 << 16);
+    srand(6502);
+    for(size_t i = 0; i < addrs.size(); i++){
+        int kind = rand() % 100;
+        if(kind < ramPercent){
+            addrs[i] = rand() % 0x2000;
+        }else if(kind < ramPercent + prgPercent){
+            addrs[i] = 0x8000 + rand() % 0x8000;
+        }else{
+            addrs[i] = 0x2000 + rand() % 0x20;
+        }
+    }
+    return addrs;
+}
+
+int main(int argc, char *argv[]){
+    long accesses = argc > 1 ? atol(argv[1]) : ACCESSES;
+
+    mos6502::i8 *flat = (mos6502::i8 *)malloc(0x10000);
+    memset(flat, 0, 0x10000);
+    state::Memory memory;
+    bus::Bus bus(memory);
+
+    const char *names[] = {"ram", "prg", "mixed"};
+    int ramPercent[] = {100, 0, 60};
+    int prgPercent[] = {0, 100, 35};
+
+    for(int w = 0; w < 3; w++){
+        std::vector<mos6502::i16> addrs = stream(ramPercent[w], prgPercent[w]);
+        size_t mask = addrs.size() - 1;
+        unsigned sink = 0;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(long i = 0; i < accesses; i++){
+            sink += flat[addrs[i & mask]];
+        }
+        double flatTime = seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        for(long i = 0; i < accesses; i++){
+            sink += ladderRead(addrs[i & mask]);
+        }
+        double ladderTime = seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        for(long i = 0; i < accesses; i++){
+            sink += bus.read(addrs[i & mask]);
+        }
+        double busTime = seconds(start);
+
+        std::cout<<names[w]<<": flat "<<(flatTime * 1e9 / accesses)<<" ns"
+                 <<", branch ladder "<<(ladderTime * 1e9 / accesses)<<" ns"
+                 <<", page table "<<(busTime * 1e9 / accesses)<<" ns"
+                 <<" ("<<(sink & 1)<<")"<<std::endl;
+    }
+
+    free(flat);
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "../include/nerones.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* PLAIN C CLIENT OF libnerones.so: LOADS A ROM FROM MEMORY, STEPS IT IN
+   BATCHES OF FRAMES AND READS THE FRAMEBUFFER AND RAM IN PLACE.
+
+     NES_CAPI <rom> [frames] */
+
+int main(int argc, char *argv[]){
+    if(argc < 2){
+        printf("Usage: %s <rom> [frames]\n", argv[0]);
+        return -1;
+    }
+    long frames = argc > 2 ? atol(argv[2]) : 6000;
+
+    FILE *file = fopen(argv[1], "rb");
+    if(file == NULL){
+        printf("file '%s' open filed\n", argv[1]);
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *image = malloc(size);
+    if(image == NULL || fread(image, 1, size, file) != (size_t)size){
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+
+    nerones *nes = nerones_create();
+    if(nes == NULL || nerones_load_memory(nes, image, size) != 0){
+        return -1;
+    }
+    free(image);
+
+    /* FETCHED ONCE, VALID FOR THE LIFE OF nes. */
+    const uint8_t *pixels = nerones_framebuffer(nes);
+    const uint8_t *ram = nerones_ram(nes);
+
+    /* 60 FRAMES PER CALL, START HELD EVERY OTHER SECOND. */
+    uint8_t inputs[2 * 60] = {0};
+    uint64_t cycles = 0;
+    uint32_t checksum = 0;
+    clock_t start = clock();
+    for(long done = 0; done < frames; done += 60){
+        for(int i = 0; i < 60; i++){
+            inputs[2 * i] = (done / 60) & 1 ? NERONES_START : 0;
+        }
+        cycles += nerones_step(nes, inputs, 60);
+        checksum = checksum * 31 + ram[0] + pixels[0];
+    }
+    double time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    /* RAM IS WRITTEN THROUGH THE BUS, WHERE $0800 MIRRORS $0000. */
+    uint8_t first = ram[0];
+    nerones_poke(nes, 0x0800, first ^ 0xFF);
+    if(ram[0] != (uint8_t)(first ^ 0xFF)){
+        printf("nerones_poke did not reach ram\n");
+        return 1;
+    }
+
+    printf("%s: api %u, %ld frames, %llu cycles, %.0f frames/s, ram checksum %08x\n", argv[1],
+           nerones_api_version(), frames, (unsigned long long)cycles, frames / time, checksum);
+    nerones_destroy(nes);
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "../include/CATALOG.h"
+#include "../include/ROM.h"
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// ROM LIBRARY INDEX (SEE CATALOG.h).
+//
+//   NES_CATALOG build <dir> <index> [threads]
+//     SCAN dir AND WRITE index, REUSING WHAT AN EARLIER index KNOWS.
+//   NES_CATALOG find <index> <key>...
+//     LOOK EACH key UP: 8 HEX DIGITS ARE A CRC-32, 40 A SHA-1, ANYTHING ELSE
+//     A PATH RELATIVE TO THE INDEXED DIRECTORY. EXIT CODE 1 IF ONE IS MISSING.
+//   NES_CATALOG list <index>
+
+static const char *TV_NAMES[] = {"NTSC", "PAL", "DUAL"};
+
+static int usage(const char *name){
+    std::cout<<"Usage: "<<name<<" build <dir> <index> [threads]"<<std::endl;
+    std::cout<<"       "<<name<<" find <index> <crc32|sha1|path>..."<<std::endl;
+    std::cout<<"       "<<name<<" list <index>"<<std::endl;
+    return -1;
+}
+
+static bool hexBytes(const char *text, mos6502::i8 *bytes, size_t count){
+    if(strlen(text) != count * 2){
+        return false;
+    }
+    for(size_t i = 0; i < count; i++){
+        unsigned value;
+        if(sscanf(text + i * 2, "%2x", &value) != 1 || !isxdigit(text[i * 2]) || !isxdigit(text[i * 2 + 1])){
+            return false;
+        }
+        bytes[i] = value;
+    }
+    return true;
+}
+
+// CRC32 SHA1 MAPPER BANKS MIRRORING TV [FLAGS] PATH
+static void print(const catalog::Index &index, const catalog::Entry &e){
+    char sha1[41];
+    for(int i = 0; i < 20; i++){
+        snprintf(sha1 + i * 2, 3, "%02x", e.sha1[i]);
+    }
+    char line[160];
+    snprintf(line, sizeof(line), "%08x %s mapper %3u prg %3u chr %3u %s %s%s%s%s ",
+             e.crc32, sha1, e.mapper, e.prgBanks, e.chrBanks,
+             (e.flags & catalog::FOUR_SCREEN) ? "4" : (e.mirroring ? "V" : "H"),
+             e.tv < 3 ? TV_NAMES[e.tv] : "?",
+             (e.flags & catalog::BATTERY) ? " battery" : "", (e.flags & catalog::TRAINER) ? " trainer" : "",
+             (e.flags & catalog::NES2) ? " nes2" : "");
+    std::cout<<line<<index.getPath(e)<<std::endl;
+}
+
+int main(int argc, char *argv[]){
+    if(argc < 3){
+        return usage(argv[0]);
+    }
+    const char *command = argv[1];
+
+    if(!strcmp(command, "build") && argc >= 4){
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        long count = catalog::build(argv[2], argv[3], argc > 4 ? atoi(argv[4]) : 0, &std::cout);
+        double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if(count < 0){
+            return -1;
+        }
+        std::cout<<argv[3]<<": "<<count<<" roms in "<<time * 1e3<<" ms"<<std::endl;
+        return 0;
+    }
+
+    catalog::Index index;
+    if(index.open(argv[2]) != 0){
+        std::cout<<"'"<<argv[2]<<"' is not a rom index"<<std::endl;
+        return -1;
+    }
+
+    if(!strcmp(command, "list")){
+        for(uint32_t i = 0; i < index.count(); i++){
+            print(index, index.at(i));
+        }
+        return 0;
+    }
+
+    if(!strcmp(command, "find") && argc >= 4){
+        int missing = 0;
+        for(int k = 3; k < argc; k++){
+            mos6502::i8 key[20];
+            const catalog::Entry *e = NULL;
+            if(hexBytes(argv[k], key, 4)){
+                uint32_t crc = strtoul(argv[k], NULL, 16);
+                for(e = index.findCRC32(crc); e && e < &index.at(0) + index.count() && e->crc32 == crc; e++){
+                    print(index, *e);
+                }
+                e = index.findCRC32(crc);
+            }else{
+                e = hexBytes(argv[k], key, 20) ? index.findSHA1(key) : index.findPath(argv[k]);
+                if(e){
+                    print(index, *e);
+                }
+            }
+            if(e == NULL){
+                std::cout<<argv[k]<<": not in the index"<<std::endl;
+                missing++;
+            }
+        }
+        return missing ? 1 : 0;
+    }
+
+    return usage(argv[0]);
+}
@@ -0,0 +1,93 @@
+#include "../include/CONFORM.h"
+#include "../include/NES.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string.h>
+#include <stdlib.h>
+
+// CPU CONFORMANCE RUNNER (SEE CONFORM.h).
+//
+//   NES_CONFORM <rom> <golden.log> [-s start] [-n instructions] [-c]
+//     RUN rom AGAINST THE LOG AND STOP AT THE FIRST DIVERGENCE. -s SETS THE
+//     PC AFTER RESET (C000 FOR nestest.nes WITHOUT A PPU), -n STOPS AFTER
+//     THAT MANY MATCHING INSTRUCTIONS, -c IGNORES CYCLE COUNTS.
+//     EXIT CODE 0 WHEN NOTHING DIVERGED, 1 WHEN SOMETHING DID.
+//
+//   NES_CONFORM -r <rom> <golden.log> <instructions> [-s start]
+//     WRITE A GOLDEN LOG OF THE FIRST instructions INSTRUCTIONS FROM THIS
+//     BUILD, TO CHECK LATER BUILDS AGAINST.
+
+static int usage(const char *name){
+    std::cout<<"Usage: "<<name<<" <rom> <golden.log> [-s start] [-n instructions] [-c]"<<std::endl;
+    std::cout<<"       "<<name<<" -r <rom> <golden.log> <instructions> [-s start]"<<std::endl;
+    return -1;
+}
+
+int main(int argc, char *argv[]){
+    bool recording = argc > 1 && !strcmp(argv[1], "-r");
+    int first = recording ? 2 : 1;
+    if(argc < first + 2 + (recording ? 1 : 0)){
+        return usage(argv[0]);
+    }
+    const char *romPath = argv[first];
+    const char *logPath = argv[first + 1];
+    uint64_t limit = recording ? strtoull(argv[first + 2], NULL, 10) : 0;
+    long start = -1;
+    bool cycles = true;
+    for(int i = first + (recording ? 3 : 2); i < argc; i++){
+        if(!strcmp(argv[i], "-s") && i + 1 < argc){
+            start = strtol(argv[++i], NULL, 16);
+        }else if(!strcmp(argv[i], "-n") && i + 1 < argc){
+            limit = strtoull(argv[++i], NULL, 10);
+        }else if(!strcmp(argv[i], "-c")){
+            cycles = false;
+        }else{
+            return usage(argv[0]);
+        }
+    }
+
+    nes::NES nes;
+    if(nes.loadRom(romPath) != 0){
+        return -1;
+    }
+    cpu::CPU *cpu = nes.getCPU();
+    if(start >= 0){
+        cpu->setPC(start);
+    }
+
+    std::chrono::steady_clock::time_point clock = std::chrono::steady_clock::now();
+    if(recording){
+        std::ofstream out(logPath, std::ios::trunc);
+        if(!out){
+            std::cout<<"file '"<<logPath<<"' open filed"<<std::endl;
+            return -1;
+        }
+        // ONE INSTRUCTION PER CALL, SO THE LOG STOPS EXACTLY AT limit.
+        trace::BinaryTrace trace(1 << 16);
+        for(uint64_t done = 0; done < limit; done++){
+            cpu->runCycles(1, trace);
+            if(trace.size() >= (1 << 15)){
+                trace.format(out);
+                trace.clear();
+            }
+        }
+        trace.format(out);
+        std::cout<<logPath<<": "<<limit<<" instructions"<<std::endl;
+        return 0;
+    }
+
+    std::ifstream in(logPath);
+    if(!in){
+        std::cout<<"file '"<<logPath<<"' open filed"<<std::endl;
+        return -1;
+    }
+    conform::Reader reader(in);
+    conform::Checker checker(reader, cycles);
+    bool passed = conform::run(*cpu, checker, limit);
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - clock).count();
+    checker.report(std::cout);
+    std::cout<<(passed ? "PASS " : "FAIL ")<<logPath<<": "<<checker.getMatched()<<" instructions in "<<time * 1e3<<" ms, "
+             <<(long)(checker.getMatched() / time)<<" instructions/s"<<std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+#include "../include/ENV.h"
+#include <iostream>
+#include <chrono>
+#include <csignal>
+#include <string.h>
+#include <stdlib.h>
+
+// SHARED-MEMORY ENVIRONMENT SERVER AND A CLIENT TO DRIVE IT (SEE ENV.h).
+//
+//   NES_ENV serve <name> <rom> <instances> [threads]
+//     HOST instances MACHINES ON rom UNTIL CTRL-C OR NES_ENV stop.
+//   NES_ENV bench <name> [steps]
+//     RUN steps ROUND TRIPS WITH PSEUDO RANDOM INPUT, RESETTING AN INSTANCE
+//     NOW AND THEN, AND REPORT ROUND TRIPS/S AND FRAMES/S.
+//   NES_ENV stop <name>
+
+static env::Server *server = NULL;
+
+static void onSignal(int){
+    server->stop();
+}
+
+static int usage(const char *name){
+    std::cout<<"Usage: "<<name<<" serve <name> <rom> <instances> [threads]"<<std::endl;
+    std::cout<<"       "<<name<<" bench <name> [steps]"<<std::endl;
+    std::cout<<"       "<<name<<" stop <name>"<<std::endl;
+    return -1;
+}
+
+int main(int argc, char *argv[]){
+    if(argc < 3){
+        return usage(argv[0]);
+    }
+    const char *command = argv[1];
+
+    if(!strcmp(command, "serve") && argc >= 5){
+        env::Server instance;
+        if(instance.open(argv[2], argv[3], atol(argv[4]), argc > 5 ? atoi(argv[5]) : 0) != 0){
+            return -1;
+        }
+        server = &instance;
+        signal(SIGINT, onSignal);
+        signal(SIGTERM, onSignal);
+        std::cout<<"serving "<<argv[4]<<" instances of "<<argv[3]<<" on /dev/shm/"<<argv[2]<<std::endl;
+        uint64_t trips = instance.run();
+        std::cout<<"served "<<trips<<" round trips"<<std::endl;
+        return 0;
+    }
+
+    env::Client client;
+    if(client.open(argv[2]) != 0){
+        std::cout<<"no server on /dev/shm/"<<argv[2]<<std::endl;
+        return -1;
+    }
+
+    if(!strcmp(command, "bench")){
+        long steps = argc > 3 ? atol(argv[3]) : 10000;
+        uint32_t instances = client.getInstances();
+        uint32_t checksum = 0;
+        srand(1);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(long s = 0; s < steps; s++){
+            for(uint32_t i = 0; i < instances; i++){
+                env::Slot *slot = client.getSlot(i);
+                slot->input[0] = rand() & 0xFF;
+                slot->reset = rand() % 1000 == 0;
+            }
+            if(client.step() != 0){
+                std::cout<<"server stopped"<<std::endl;
+                return -1;
+            }
+            for(uint32_t i = 0; i < instances; i++){
+                checksum = checksum * 31 + client.getSlot(i)->ram[s & 0x7FF];
+            }
+        }
+        double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout<<steps<<" round trips x "<<instances<<" instances: "<<(time * 1e6 / steps)<<" us/round trip, "
+                 <<(long)(steps * instances / time)<<" frames/s, ram checksum "<<std::hex<<checksum<<std::dec<<std::endl;
+        return 0;
+    }
+
+    if(!strcmp(command, "stop")){
+        client.shutdown();
+        return 0;
+    }
+
+    return usage(argv[0]);
+}
@@ -0,0 +1,54 @@
+#include "../include/NES.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <stdlib.h>
+
+// RUNS A ROM ON nes::NES WITH NO WINDOW, LINKED AGAINST libnerones.a ONLY.
+//
+//   NES_HEADLESS <rom> [frames] [buttons] [out.ppm]
+//
+// HOLDS buttons (A JoyPads::Button MASK, E.G. 0x08 FOR START) ON PORT 0 FOR
+// frames FRAMES, REPORTS STARTUP TIME AND FRAMES/S, AND WRITES THE LAST
+// FRAMEBUFFER AS A PPM WHEN ASKED.
+
+int main(int argc, char *argv[]){
+    if(argc < 2){
+        std::cout<<"Usage: "<<argv[0]<<" <rom> [frames] [buttons] [out.ppm]"<<std::endl;
+        return -1;
+    }
+    long frames = argc > 2 ? atol(argv[2]) : 600;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    nes::NES nes;
+    if(nes.loadRom(argv[1]) != 0){
+        return -1;
+    }
+    double boot = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    nes.setInput(0, argc > 3 ? strtol(argv[3], NULL, 0) : 0);
+    uint64_t cycles = 0;
+    start = std::chrono::steady_clock::now();
+    for(long i = 0; i < frames; i++){
+        cycles += nes.stepFrame();
+    }
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout<<argv[1]<<": loaded in "<<boot * 1e3<<" ms, "<<frames<<" frames, "<<cycles<<" cycles, "
+             <<(long)(frames / time)<<" frames/s, PC "<<std::hex<<nes.getCPU()->getPC()<<std::dec<<std::endl;
+
+    if(argc > 4){
+        std::ofstream out(argv[4], std::ios::binary | std::ios::trunc);
+        if(!out){
+            std::cout<<"file '"<<argv[4]<<"' open filed"<<std::endl;
+            return -1;
+        }
+        out<<"P6\n"<<nes::NES::WIDTH<<" "<<nes::NES::HEIGHT<<"\n255\n";
+        const mos6502::i8 *frame = nes.framebuffer();
+        for(int i = 0; i < nes::NES::WIDTH * nes::NES::HEIGHT; i++){
+            uint32_t rgb = ppu::PALETTE[frame[i] & 0x3F];
+            char pixel[3] = {(char)(rgb >> 16), (char)(rgb >> 8), (char)rgb};
+            out.write(pixel, 3);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "../include/MOVIE.h"
+#include "../include/ROM.h"
+#include "../include/MAPPER.h"
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <string.h>
+#include <stdlib.h>
+
+// INPUT MOVIE TOOL.
+//
+//   NES_MOVIE record <rom> <frames> <movie> [seed] [interval]
+//     RECORD frames FRAMES OF PSEUDO RANDOM INPUT (A BUTTON MASK HELD FOR
+//     1-30 FRAMES AT A TIME) FROM POWER ON, WITH A KEYFRAME EVERY interval.
+//   NES_MOVIE verify <rom> <movie>
+//     PLAY THE MOVIE FROM POWER ON AND CHECK EVERY KEYFRAME.
+//   NES_MOVIE seek <rom> <movie> [seeks]
+//     SEEK TO seeks RANDOM FRAMES AND REPORT WHAT A SEEK COSTS.
+
+static int usage(const char *name){
+    std::cout<<"Usage: "<<name<<" record <rom> <frames> <movie> [seed] [interval]"<<std::endl;
+    std::cout<<"       "<<name<<" verify <rom> <movie>"<<std::endl;
+    std::cout<<"       "<<name<<" seek <rom> <movie> [seeks]"<<std::endl;
+    return -1;
+}
+
+static double seconds(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]){
+    if(argc < 4){
+        return usage(argv[0]);
+    }
+    const char *command = argv[1];
+
+    rom::ROM rom;
+    if(rom.loadNesFile(argv[2]) != 0){
+        return -1;
+    }
+    std::unique_ptr<cpu::CPU> cpu(new cpu::CPU());
+    cpu->reset();
+    std::unique_ptr<mapper::Mapper> cart(mapper::create(rom, *cpu));
+    cart->reset();
+    cpu->readResetVector();
+    nes::JoyPads pads(cpu->getBus(), cpu->getPads());
+
+    movie::Movie movie;
+    movie::Player player(movie, *cpu, pads);
+
+    if(!strcmp(command, "record") && argc >= 5){
+        uint32_t frames = atol(argv[3]);
+        srand(argc > 5 ? atoi(argv[5]) : 1);
+        movie.create(rom.getCRC32(), 1, argc > 6 ? atol(argv[6]) : movie::INTERVAL);
+        mos6502::i8 input = 0;
+        int hold = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < frames; i++){
+            if(--hold <= 0){
+                input = rand() & 0xFF;
+                hold = 1 + rand() % 30;
+            }
+            player.record(&input);
+        }
+        double time = seconds(start);
+        if(movie.save(argv[4]) != 0){
+            return -1;
+        }
+        std::cout<<argv[4]<<": "<<frames<<" frames, "<<movie.getKeyframes()<<" keyframes, "
+                 <<(long)(frames / time)<<" frames/s recorded"<<std::endl;
+        return 0;
+    }
+
+    if(movie.load(argv[3]) != 0){
+        return -1;
+    }
+    if(movie.getRomCRC() != rom.getCRC32()){
+        std::cout<<argv[3]<<": recorded on another ROM"<<std::endl;
+        return -1;
+    }
+
+    if(!strcmp(command, "verify")){
+        uint32_t checked;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        uint32_t mismatches = player.verify(checked);
+        double time = seconds(start);
+        std::cout<<argv[3]<<": "<<movie.getFrames()<<" frames, "<<checked<<" keyframes checked, "<<mismatches<<" desynced, "
+                 <<(long)(movie.getFrames() / time)<<" frames/s"<<std::endl;
+        return mismatches ? 1 : 0;
+    }
+
+    if(!strcmp(command, "seek")){
+        long seeks = argc > 4 ? atol(argv[4]) : 1000;
+        uint64_t replayed = 0;
+        srand(1);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(long i = 0; i < seeks; i++){
+            replayed += player.seek(rand() % (movie.getFrames() + 1));
+        }
+        double time = seconds(start);
+        std::cout<<argv[3]<<": "<<seeks<<" seeks, "<<(time * 1e6 / seeks)<<" us/seek, "
+                 <<(double)replayed / seeks<<" frames replayed/seek (interval "<<movie.getInterval()<<")"<<std::endl;
+        return 0;
+    }
+
+    return usage(argv[0]);
+}
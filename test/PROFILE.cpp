@@ -0,0 +1,43 @@
+#include "../include/NES.h"
+#include "../include/TRACE.h"
+#include <iostream>
+#include <chrono>
+#include <stdlib.h>
+
+// WHERE A ROM SPENDS ITS CYCLES (SEE trace::Profile).
+//
+//   NES_PROFILE <rom> [frames] [top] [heatmap.pgm]
+//
+// RUNS frames FRAMES ON nes::NES WITH NO INPUT UNDER THE PROFILE POLICY AND
+// PRINTS THE top HOTTEST OPCODES, PRG LOCATIONS AND BANKS. THE POLICY RECORDS, SO IDLE LOOP
+// SKIPPING AND THE JIT ARE OFF: THIS IS EVERY INSTRUCTION THE GAME RUNS. THE
+// FRAMES ARE stepFrame()'S, VBLANK AND NMI INCLUDED.
+
+int main(int argc, char *argv[]){
+    if(argc < 2){
+        std::cout<<"Usage: "<<argv[0]<<" <rom> [frames] [top] [heatmap.pgm]"<<std::endl;
+        return -1;
+    }
+    long frames = argc > 2 ? atol(argv[2]) : 600;
+    int top = argc > 3 ? atoi(argv[3]) : 20;
+
+    nes::NES nes;
+    if(nes.loadRom(argv[1]) != 0){
+        return -1;
+    }
+    cpu::CPU *cpu = nes.getCPU();
+    trace::Profile profile(cpu->getCart().prg, nes.getROM()->getPRGBanks() * (rom::ROM::PRG_BANK_SIZE / trace::Profile::BANK_SIZE));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(long i = 0; i < frames; i++){
+        cpu->runFrame(profile);
+    }
+    profile.finish(cpu->getCycles());
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout<<argv[1]<<": "<<frames<<" frames profiled in "<<time * 1e3<<" ms"<<std::endl;
+    profile.report(std::cout, top);
+    if(argc > 4 && !profile.heatmap(argv[4])){
+        return -1;
+    }
+    return 0;
+}
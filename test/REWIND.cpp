@@ -0,0 +1,168 @@
+#include "../include/CPU.h"
+#include "../include/ROM.h"
+#include "../include/REWIND.h"
+#include <iostream>
+#include <sstream>
+#include <deque>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+
+// REWIND ROUND TRIP CHECK (SEE REWIND.h).
+//
+//   NES_REWIND [rom] [frames] [seed]
+//
+// THE CODEC FIRST: RANDOM BUFFERS AGAINST RANDOM REFERENCES MUST DECODE BACK
+// BYTE EXACT, AND A TOKEN PAST THE END OF THE BLOB OR OF THE TARGET MUST BE
+// REFUSED. THEN THE RING: rom (game_rom/zelda.nes) RUNS frames FRAMES (5000)
+// WITH RANDOM INPUT AND RANDOM RAM POKES, EVERY ARENA PUSHED IS KEPT ASIDE,
+// AND AT RANDOM FRAMES THE BUFFER STEPS BACK A RANDOM DISTANCE. THE STATE IT
+// GIVES BACK MUST BE THE SAVED ONE BYTE FOR BYTE, AND THE MACHINE CARRIES ON
+// FROM THERE. THAT RUNS ONCE PER SETUP BELOW; THE SMALL RINGS KEEP EVICTING
+// AND WRAPPING AROUND, INTERVAL 1 MAKES EVERY FRAME A KEYFRAME.
+//
+// EXIT CODE 0 WHEN EVERYTHING MATCHED, 1 AT THE FIRST MISMATCH.
+
+static const long FRAMES = 5000;
+
+static const struct Setup{
+    size_t capacity;        // 0: THE SMALLEST RING THE BUFFER ACCEPTS
+    int interval;
+} setups[] = {
+    {0, 1},
+    {0, 7},
+    {64 * 1024, 1},
+    {64 * 1024, 60},
+    {1024 * 1024, 300},
+};
+
+static bool checkCodec(long rounds){
+    const size_t size = sizeof(state::Machine);
+    std::vector<mos6502::i8> data(size), ref(size), out(size);
+    std::vector<mos6502::i8> encoded(history::maxEncoded(size));
+    for(long r = 0; r < rounds; r++){
+        // SPARSE, DENSE AND EVERYTHING BETWEEN.
+        int density = rand() % 101;
+        for(size_t i = 0; i < size; i++){
+            ref[i]  = rand();
+            data[i] = rand() % 100 < density ? rand() : ref[i];
+        }
+        size_t length = history::encode(&data[0], &ref[0], size, &encoded[0]);
+        out = ref;
+        if(length > encoded.size() || !history::apply(&encoded[0], length, &out[0], size) || out != data){
+            std::cout<<"codec round "<<r<<": "<<length<<" bytes do not decode back"<<std::endl;
+            return false;
+        }
+        // A BLOB CUT INSIDE A TOKEN, OR A TARGET ONE BYTE SHORT OF THE LAST
+        // ONE, IS REFUSED RATHER THAN READ OR WRITTEN PAST.
+        std::vector<size_t> tokens;
+        size_t end = 0;
+        for(size_t pos = 0; pos < length;){
+            size_t count = encoded[pos + 2] | (encoded[pos + 3] << 8);
+            end += (encoded[pos] | (encoded[pos + 1] << 8)) + count;
+            pos += 4 + count;
+            tokens.push_back(pos);
+        }
+        if(length > 0){
+            size_t cut = rand() % length;
+            bool boundary = cut == 0;
+            for(size_t i = 0; i < tokens.size(); i++){
+                boundary = boundary || tokens[i] == cut;
+            }
+            out = ref;
+            if(history::apply(&encoded[0], cut, &out[0], size) != boundary
+               || history::apply(&encoded[0], length, &out[0], end - 1)){
+                std::cout<<"codec round "<<r<<": a truncated blob or target was accepted"<<std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool checkRing(rom::ROM &rom, const Setup &setup, long frames){
+    rom::Span first = rom.getPRG(0);
+    rom::Span last  = rom.getPRG(rom.getPRGBanks() - 1);
+    cpu::CPU *cpu = new cpu::CPU();
+    cpu->reset();
+    cpu->setPRG1(first.data, first.size);
+    cpu->setPRG2(last.data, last.size);
+    cpu->readResetVector();
+    history::Buffer buffer(setup.capacity, setup.interval);
+    // saved[i] IS THE i-TH FRAME STILL IN THE TIMELINE; THE BUFFER HOLDS ITS TAIL.
+    std::deque<state::Machine> saved;
+    long rewinds = 0, stepped = 0;
+    for(long f = 0; f < frames; f++){
+        cpu->write(0x4016, rand());
+        for(int i = rand() % 4; i > 0; i--){
+            cpu->write(rand() % 0x800, rand());
+        }
+        cpu->runFrame();
+        buffer.push(cpu->getState());
+        saved.push_back(cpu->getState());
+        while(saved.size() > buffer.getFrames()){
+            saved.pop_front();
+        }
+
+        if(rand() % 16){
+            continue;
+        }
+        // PAST THE OLDEST FRAME HELD IT STOPS AT THE OLDEST.
+        int held = buffer.getFrames();
+        int back = rand() % (held + 8);
+        int expected = back < held ? back : held - 1;
+        state::Machine machine;
+        int got = buffer.rewind(back, machine);
+        if(got != expected){
+            std::cout<<"frame "<<f<<": asked for "<<back<<" frames back, got "<<got<<std::endl;
+            delete cpu;
+            return false;
+        }
+        if(got == 0){
+            continue;
+        }
+        saved.resize(saved.size() - got);
+        if(memcmp(&machine, &saved.back(), sizeof(machine)) != 0){
+            std::cout<<"frame "<<f<<": "<<got<<" frames back is not the state saved then"<<std::endl;
+            delete cpu;
+            return false;
+        }
+        cpu->loadState(machine);
+        rewinds++;
+        stepped += got;
+    }
+    const history::Stats &stats = buffer.getStats();
+    std::cout<<"capacity "<<buffer.getCapacity()<<", interval "<<setup.interval<<": "<<rewinds<<" rewinds, "
+             <<stepped<<" frames back, "<<stats.keyframes<<" keyframes, "<<stats.dropped<<" evicted, "
+             <<buffer.getFrames()<<" held"<<std::endl;
+    delete cpu;
+    return true;
+}
+
+int main(int argc, char *argv[]){
+    const char *rom = argc > 1 ? argv[1] : "game_rom/zelda.nes";
+    long frames = argc > 2 ? atol(argv[2]) : FRAMES;
+    srand(argc > 3 ? atoi(argv[3]) : 1);
+
+    if(!checkCodec(2000)){
+        return 1;
+    }
+    std::cout<<"codec: 2000 random round trips"<<std::endl;
+
+    rom::ROM image;
+    std::streambuf *console = std::cout.rdbuf();
+    std::ostringstream chatter;
+    std::cout.rdbuf(chatter.rdbuf());
+    int loaded = image.loadNesFile(rom);
+    std::cout.rdbuf(console);
+    if(loaded != 0 || image.getPRGBanks() == 0){
+        std::cout<<"file '"<<rom<<"' is not a rom"<<std::endl;
+        return -1;
+    }
+    for(size_t i = 0; i < sizeof(setups) / sizeof(setups[0]); i++){
+        if(!checkRing(image, setups[i], frames)){
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,231 @@
+#include "../include/NES.h"
+#include "../include/REWIND.h"
+#include "../include/TRACE.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+// HEADLESS BENCHMARK SUITE, JSON OUT.
+//
+//   NES_SUITE [-f frames] [-b baseline.json] [-t percent]
+//
+// RUNS EACH ROM IN game_rom/ ON nes::NES FOR frames FRAMES (NO INPUT) AND
+// PRINTS ONE JSON DOCUMENT: PER ROM THE INSTRUCTIONS THE FRAMES CONTAIN, THE
+// FRAMES/S AND INSTRUCTIONS/S OF THE CORE, AND NS PER FRAME OF EACH LAYER
+// MEASURED ON ITS OWN:
+//
+//   cpu            INTERPRETER, IDLE SKIP OFF: THE CORE ALONE, WHAT
+//                  frames_per_second AND instructions_per_second ARE
+//   cpu_idle_skip  THE DEFAULT CONFIGURATION
+//   cpu_jit        JIT TIER ON (SAME AS cpu WITHOUT HAVE_JIT)
+//   framebuffer    INDEX TO RGB OF ONE PICTURE, WHAT A FRONT END PAYS
+//   savestate      ONE cpu::CPU::saveState()
+//   rewind         ONE history::Buffer::push()
+//
+// EVERY FRAME IS ONE nes::NES::stepFrame(), VBLANK AND NMI INCLUDED, SO THE
+// NUMBERS ARE THOSE OF THE FRAME A FRONT END RUNS.
+//
+// INSTRUCTIONS ARE COUNTED IN A SEPARATE PASS OF THE SAME FRAMES UNDER
+// trace::CountTrace, WHICH RUNS EVERY ONE, SO THEY INCLUDE THE POLLING LOOPS
+// IDLE SKIPPING JUMPS OVER. getrusage() ONLY KNOWS THE HIGH WATER MARK OF THE
+// WHOLE PROCESS, SO peak_rss_kb_so_far OF A ROM COVERS IT AND EVERY ROM BEFORE
+// IT; ONLY THE LAST ONE, THE TOP LEVEL peak_rss_kb, MEANS ANYTHING ON ITS OWN.
+//
+// EACH ROM IS ONE LINE OF THE OUTPUT. WITH -b THE RESULTS ARE ALSO COMPARED
+// WITH A SAVED RUN: A ROM WHOSE frames_per_second DROPPED BY MORE THAN -t
+// PERCENT (DEFAULT 10) IS REPORTED ON STDERR AND THE EXIT CODE IS 1.
+
+static const char *roms[] = {
+    "game_rom/Super_mario_brothers.nes",
+    "game_rom/donkykong.nes",
+    "game_rom/zelda.nes",
+    "game_rom/nomolos.nes",
+};
+
+static const long FRAMES = 3000;
+static const int VERSION = 3;
+
+static double seconds(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static long peakRSS(){
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef OSX
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+// SECONDS FOR frames FRAMES ON A FRESH MACHINE.
+static double runFrames(nes::NES &nes, long frames, bool idleSkip, bool jit){
+    nes.reset();
+    cpu::CPU *cpu = nes.getCPU();
+    cpu->setIdleSkip(idleSkip);
+    cpu->setJit(jit);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(long i = 0; i < frames; i++){
+        nes.stepFrame();
+    }
+    double time = seconds(start);
+    nes.getCPU()->setIdleSkip(true);
+    nes.getCPU()->setJit(false);
+    return time;
+}
+
+// "key": NUMBER OUT OF ONE LINE OF OUR OWN OUTPUT.
+static bool field(const std::string &line, const char *key, double &value){
+    std::string quoted = std::string("\"") + key + "\":";
+    size_t at = line.find(quoted);
+    if(at == std::string::npos){
+        return false;
+    }
+    value = atof(line.c_str() + at + quoted.size());
+    return true;
+}
+
+static bool loadBaseline(const char *path, std::map<std::string, double> &baseline){
+    std::ifstream in(path);
+    if(!in){
+        std::cerr<<"file '"<<path<<"' open filed"<<std::endl;
+        return false;
+    }
+    std::string line;
+    double version;
+    if(!std::getline(in, line) || !field(line, "version", version) || version != VERSION){
+        std::cerr<<"file '"<<path<<"' is not a version "<<VERSION<<" suite run"<<std::endl;
+        return false;
+    }
+    while(std::getline(in, line)){
+        static const std::string key = "\"rom\": \"";
+        size_t at = line.find(key);
+        double fps;
+        if(at != std::string::npos && field(line, "frames_per_second", fps)){
+            size_t start = at + key.size();
+            baseline[line.substr(start, line.find('"', start) - start)] = fps;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]){
+    long frames = FRAMES;
+    const char *baselinePath = NULL;
+    double tolerance = 10;
+    for(int i = 1; i < argc; i++){
+        if(!strcmp(argv[i], "-f") && i + 1 < argc){
+            frames = atol(argv[++i]);
+        }else if(!strcmp(argv[i], "-b") && i + 1 < argc){
+            baselinePath = argv[++i];
+        }else if(!strcmp(argv[i], "-t") && i + 1 < argc){
+            tolerance = atof(argv[++i]);
+        }else{
+            std::cerr<<"Usage: "<<argv[0]<<" [-f frames] [-b baseline.json] [-t percent]"<<std::endl;
+            return -1;
+        }
+    }
+    if(frames <= 0){
+        frames = FRAMES;
+    }
+    std::map<std::string, double> baseline;
+    if(baselinePath && !loadBaseline(baselinePath, baseline)){
+        return -1;
+    }
+
+    // ROM LOADING TALKS ON STDOUT; KEEP IT OUT OF THE JSON.
+    std::streambuf *console = std::cout.rdbuf();
+    std::ostringstream chatter;
+    std::ostringstream json;
+    int regressions = 0;
+
+    json<<"{\"version\": "<<VERSION<<", \"frames\": "<<frames<<", \"roms\": [\n";
+    bool first = true;
+    for(unsigned r = 0; r < sizeof(roms)/sizeof(roms[0]); r++){
+        nes::NES nes;
+        std::cout.rdbuf(chatter.rdbuf());
+        int loaded = nes.loadRom(roms[r]);
+        std::cout.rdbuf(console);
+        if(loaded != 0){
+            continue;
+        }
+        cpu::CPU *cpu = nes.getCPU();
+
+        // INSTRUCTIONS AND CYCLES OF THE FRAMES: stepFrame()'S FRAME, COUNTED.
+        trace::CountTrace counter;
+        uint64_t startCycles = cpu->getCycles();
+        for(long i = 0; i < frames; i++){
+            cpu->runFrame(counter);
+        }
+        uint64_t cycles = cpu->getCycles() - startCycles;
+
+        double core = runFrames(nes, frames, false, false);
+        double jit = runFrames(nes, frames, false, true);
+        double standard = runFrames(nes, frames, true, false);
+
+        // THE PER-FRAME EXTRAS, EACH ON THE STATE THE DEFAULT RUN ENDED IN.
+        std::vector<mos6502::i8> rgb(nes::NES::WIDTH * nes::NES::HEIGHT * 3);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(long f = 0; f < frames; f++){
+            const mos6502::i8 *frame = nes.framebuffer();
+            for(int i = 0; i < nes::NES::WIDTH * nes::NES::HEIGHT; i++){
+                uint32_t color = ppu::PALETTE[frame[i] & 0x3F];
+                rgb[i * 3]     = color >> 16;
+                rgb[i * 3 + 1] = color >> 8;
+                rgb[i * 3 + 2] = color;
+            }
+        }
+        double framebuffer = seconds(start);
+
+        state::Machine snapshot;
+        start = std::chrono::steady_clock::now();
+        for(long f = 0; f < frames; f++){
+            cpu->saveState(snapshot);
+        }
+        double savestate = seconds(start);
+
+        // PUSHES OF THE FRAMES AS THEY ARE RUN, SO THE DELTAS ARE REAL ONES.
+        history::Buffer rewind(8 * 1024 * 1024);
+        nes.reset();
+        double pushing = 0;
+        for(long f = 0; f < frames; f++){
+            nes.stepFrame();
+            start = std::chrono::steady_clock::now();
+            rewind.push(cpu->getState());
+            pushing += seconds(start);
+        }
+
+        double fps = frames / core;
+        char line[1024];
+        snprintf(line, sizeof(line),
+                 "  {\"rom\": \"%s\", \"crc32\": \"%08x\", \"frames\": %ld, \"instructions\": %llu, \"cycles\": %llu, "
+                 "\"seconds\": %.6f, \"frames_per_second\": %.1f, \"instructions_per_second\": %.0f, "
+                 "\"ns_per_frame\": {\"cpu\": %.1f, \"cpu_idle_skip\": %.1f, \"cpu_jit\": %.1f, "
+                 "\"framebuffer\": %.1f, \"savestate\": %.1f, \"rewind\": %.1f}, \"peak_rss_kb_so_far\": %ld}",
+                 roms[r], nes.getROM()->getCRC32(), frames, (unsigned long long)counter.count, (unsigned long long)cycles,
+                 core, fps, counter.count / core,
+                 core * 1e9 / frames, standard * 1e9 / frames, jit * 1e9 / frames,
+                 framebuffer * 1e9 / frames, savestate * 1e9 / frames, pushing * 1e9 / frames, peakRSS());
+        json<<(first ? "" : ",\n")<<line;
+        first = false;
+
+        std::map<std::string, double>::iterator old = baseline.find(roms[r]);
+        if(old != baseline.end() && fps < old->second * (1 - tolerance / 100)){
+            std::cerr<<roms[r]<<": "<<(long)fps<<" frames/s, baseline "<<(long)old->second
+                     <<" ("<<(long)((1 - fps / old->second) * 100)<<"% slower)"<<std::endl;
+            regressions++;
+        }
+    }
+    json<<"\n], \"peak_rss_kb\": "<<peakRSS()<<"}";
+    std::cout<<json.str()<<std::endl;
+    return regressions ? 1 : 0;
+}
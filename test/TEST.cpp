@@ -28,13 +28,15 @@ int main(int argc, char *argv[]){
     cpu::CPU cpu;
     cpu.reset();
            
-    cpu.setPRG1(rom.getPRGROM()[0]);                            // 0x8000 
-    cpu.setPRG2(rom.getPRGROM()[rom.getPRGROM().size()-1]);     // 0xC000
+    rom::Span first = rom.getPRG(0);
+    rom::Span last  = rom.getPRG(rom.getPRGBanks() - 1);
+    cpu.setPRG1(first.data, first.size);                        // 0x8000 
+    cpu.setPRG2(last.data, last.size);                          // 0xC000
 
     // 35 D7 D0 D6 44 D7
     //     
-    std::cout<<"RESET:"<<(0xFF & rom.getPRGROM()[rom.getPRGROM().size()-1][rom.getPRGROM()[rom.getPRGROM().size()-1].size()-4])<<std::endl;
-    std::cout<<"RESET:"<<(0xFF & rom.getPRGROM()[rom.getPRGROM().size()-1][rom.getPRGROM()[rom.getPRGROM().size()-1].size()-3])<<std::endl;
+    std::cout<<"RESET:"<<(0xFF & last[last.size-4])<<std::endl;
+    std::cout<<"RESET:"<<(0xFF & last[last.size-3])<<std::endl;
     
     cpu.run();
     */